@@ -0,0 +1,53 @@
+#ifndef _ARMS_CHARACTERIZE_H_
+#define _ARMS_CHARACTERIZE_H_
+
+#include <cstdint>
+
+namespace arms::chassis {
+
+// File written by characterize() and read by tools/fit_drive.cpp
+const char* const CHARACTERIZE_FILE = "/usd/arms_drive.bin";
+
+// Format version, written in the file header
+const std::uint16_t CHARACTERIZE_VERSION = 1;
+
+// The tests characterize() runs, in order
+typedef enum CharacterizeTest {
+	TEST_QUASISTATIC_FORWARD = 1, // voltage ramped slowly, so a ~ 0
+	TEST_QUASISTATIC_BACKWARD,
+	TEST_DYNAMIC_FORWARD, // voltage stepped, so a is large
+	TEST_DYNAMIC_BACKWARD,
+	TEST_SPIN_LEFT, // slow ramps turning in place, for the track width
+	TEST_SPIN_RIGHT
+} CharacterizeTest_e_t;
+
+// Header at the start of the file
+struct CharacterizeHeader {
+	char magic[4];            // "ARMS"
+	std::uint16_t version;    // CHARACTERIZE_VERSION
+	std::uint16_t sampleSize; // sizeof(CharacterizeSample)
+	std::uint32_t count;      // samples that follow
+	std::uint32_t period;     // sample period in milliseconds
+};
+static_assert(sizeof(CharacterizeHeader) == 16,
+              "characterization headers must not be padded");
+
+// One sample of a test
+struct CharacterizeSample {
+	std::uint32_t time;        // microseconds since the test started
+	std::int16_t leftVoltage;  // millivolts sent to the motors
+	std::int16_t rightVoltage; // millivolts sent to the motors
+	float leftVelocity;        // rpm, the mean of the left motors
+	float rightVelocity;       // rpm, the mean of the right motors
+	float x;                   // inches
+	float y;                   // inches
+	float heading;             // radians, counterclockwise positive
+	std::uint8_t test;         // CharacterizeTest_e_t
+	std::uint8_t reserved[3];
+};
+static_assert(sizeof(CharacterizeSample) == 32,
+              "characterization samples must not be padded");
+
+} // namespace arms::chassis
+
+#endif
@@ -3,15 +3,35 @@
 
 #include "ARMS/flags.h"
 #include "ARMS/point.h"
+#include "ARMS/trajectory.h"
 #include <memory>
 #include "../api.h"
 
 namespace arms::chassis {
 
 extern double maxSpeed;
+extern int loopPeriod;
 extern std::shared_ptr<pros::Motor_Group> leftMotors;
 extern std::shared_ptr<pros::Motor_Group> rightMotors;
 
+// Control loop timing statistics, all durations in microseconds
+typedef struct loop_stats_s {
+	std::uint32_t period;   // configured loop period in milliseconds
+	std::uint32_t ticks;    // number of ticks executed
+	std::uint32_t overruns; // ticks that took longer than the period
+	std::uint32_t last;     // compute time of the most recent tick
+	std::uint32_t max;      // longest compute time of any tick
+	std::uint64_t total;    // summed compute time of every tick
+} loop_stats_s_t;
+
+// Why a movement finished
+typedef enum exit_reason {
+	EXIT_NONE,     // still running
+	EXIT_TARGET,   // within the exit error of the target
+	EXIT_SETTLED,  // stopped moving short of the target
+	EXIT_REPLACED  // replaced by a new movement before finishing
+} ExitReason_e_t;
+
 /**
  * Set the brake mode for all chassis motors
  */
@@ -23,7 +43,15 @@ void setBrakeMode(pros::motor_brake_mode_e_t b);
 bool settled();
 
 /**
- * Wait for the chassis to complete the current movement
+ * Wait for the chassis to complete the last movement issued, including queued
+ * movements, or for a later movement to replace it. Any number of tasks can
+ * wait at once
+ */
+void waitUntilFinished();
+
+/**
+ * Wait for the chassis to complete the current movement, using a new exit
+ * error for it
  */
 void waitUntilFinished(double exit_error);
 
@@ -65,6 +93,115 @@ void turn(Point target, double max, double exit_error, MoveFlags = NONE);
 void turn(Point target, double max, MoveFlags = NONE);
 void turn(Point target, MoveFlags = NONE);
 
+/**
+ * Follow a trajectory with adaptive lookahead pure pursuit, at the speeds it
+ * was generated with. Finishes within exit_error of the last point. The
+ * states of a Trajectory or TrajectoryView, such as a baked path, are used in
+ * place and are never copied, so they must outlive the movement. That is
+ * always the case for a blocking movement, but with ASYNC or the queue the
+ * trajectory must not be a local that goes out of scope first. Temporaries
+ * are rejected at compile time.
+ * Only the ASYNC and THRU flags apply; the direction and position come from
+ * the trajectory, so REVERSE and RELATIVE are ignored. Generate a reversed
+ * trajectory to drive backwards.
+ */
+void follow(const Trajectory& path, double max, double exit_error,
+            MoveFlags = NONE);
+void follow(const Trajectory& path, double max, MoveFlags = NONE);
+void follow(const Trajectory& path, MoveFlags = NONE);
+void follow(TrajectoryView path, double max, double exit_error,
+            MoveFlags = NONE);
+void follow(TrajectoryView path, double max, MoveFlags = NONE);
+void follow(TrajectoryView path, MoveFlags = NONE);
+void follow(Trajectory&& path, double max, double exit_error,
+            MoveFlags = NONE) = delete;
+void follow(Trajectory&& path, double max, MoveFlags = NONE) = delete;
+void follow(Trajectory&& path, MoveFlags = NONE) = delete;
+
+/**
+ * Track a trajectory in time with the ramsete controller, which drives the
+ * wheels at the trajectory velocities and corrects errors in position and
+ * heading along the way. Finishes once the trajectory time runs out within
+ * exit_error of the last point, or the robot settles. The trajectory must
+ * outlive the movement, and the flags apply as for follow().
+ */
+void track(const Trajectory& path, double max, double exit_error,
+           MoveFlags = NONE);
+void track(const Trajectory& path, double max, MoveFlags = NONE);
+void track(const Trajectory& path, MoveFlags = NONE);
+void track(TrajectoryView path, double max, double exit_error,
+           MoveFlags = NONE);
+void track(TrajectoryView path, double max, MoveFlags = NONE);
+void track(TrajectoryView path, MoveFlags = NONE);
+void track(Trajectory&& path, double max, double exit_error,
+           MoveFlags = NONE) = delete;
+void track(Trajectory&& path, double max, MoveFlags = NONE) = delete;
+void track(Trajectory&& path, MoveFlags = NONE) = delete;
+
+/**
+ * A sequence of movements run back to back by the chassis. Each movement
+ * starts on the control loop tick after the previous one meets its exit
+ * condition, and relative targets are taken from the pose at that moment.
+ * Queueing never blocks unless the queue is full. follow() and track() take
+ * no flags, since none of them apply to a queued trajectory. For example:
+ *
+ *     chassis::queue().move(24).turn(90).move({48, 24}, THRU).move(12);
+ *     chassis::waitUntilFinished();
+ */
+class Queue {
+	public:
+	Queue& move(std::vector<double> target, double max, double exit_error,
+	            double lp, double ap, MoveFlags = NONE);
+	Queue& move(std::vector<double> target, double max, double exit_error,
+	            MoveFlags = NONE);
+	Queue& move(std::vector<double> target, double max, MoveFlags = NONE);
+	Queue& move(std::vector<double> target, MoveFlags = NONE);
+
+	Queue& move(double target, double max, double exit_error, double lp,
+	            double ap, MoveFlags = NONE);
+	Queue& move(double target, double max, double exit_error, MoveFlags = NONE);
+	Queue& move(double target, double max, MoveFlags = NONE);
+	Queue& move(double target, MoveFlags = NONE);
+
+	Queue& turn(double target, double max, double exit_error, double ap,
+	            MoveFlags = NONE);
+	Queue& turn(double target, double max, double exit_error, MoveFlags = NONE);
+	Queue& turn(double target, double max, MoveFlags = NONE);
+	Queue& turn(double target, MoveFlags = NONE);
+
+	Queue& turn(Point target, double max, double exit_error, double ap,
+	            MoveFlags = NONE);
+	Queue& turn(Point target, double max, double exit_error, MoveFlags = NONE);
+	Queue& turn(Point target, double max, MoveFlags = NONE);
+	Queue& turn(Point target, MoveFlags = NONE);
+
+	Queue& follow(const Trajectory& path, double max, double exit_error);
+	Queue& follow(const Trajectory& path, double max);
+	Queue& follow(const Trajectory& path);
+	Queue& follow(TrajectoryView path, double max, double exit_error);
+	Queue& follow(TrajectoryView path, double max);
+	Queue& follow(TrajectoryView path);
+	Queue& follow(Trajectory&& path, double max, double exit_error) = delete;
+	Queue& follow(Trajectory&& path, double max) = delete;
+	Queue& follow(Trajectory&& path) = delete;
+
+	Queue& track(const Trajectory& path, double max, double exit_error);
+	Queue& track(const Trajectory& path, double max);
+	Queue& track(const Trajectory& path);
+	Queue& track(TrajectoryView path, double max, double exit_error);
+	Queue& track(TrajectoryView path, double max);
+	Queue& track(TrajectoryView path);
+	Queue& track(Trajectory&& path, double max, double exit_error) = delete;
+	Queue& track(Trajectory&& path, double max) = delete;
+	Queue& track(Trajectory&& path) = delete;
+};
+
+/**
+ * Return the movement queue. Issuing a movement with move() or turn() clears
+ * anything still queued.
+ */
+Queue& queue();
+
 /**
  * Assign a power to the left and right motors
  */
@@ -75,6 +212,27 @@ void tank(double left, double right, bool velocity = false);
  */
 void arcade(double vertical, double horizontal, bool velocity = false);
 
+/**
+ * Measure the drive for feedforward and simulation. Each side is driven with
+ * slow voltage ramps of ramp volts per second and steps of step volts, forward
+ * then back over up to distance inches, followed by a ramp spinning in place
+ * each way. Voltages, motor velocities and the pose are kept in memory and
+ * written to /usd/arms_drive.bin when the tests finish, for
+ * tools/fit_drive.cpp to fit kS, kV and kA for each side and the effective
+ * track width. Blocks until done, and needs room to drive in a straight line.
+ */
+void characterize(double distance = 48, double ramp = 1, double step = 6);
+
+/**
+ * Return the control loop timing statistics
+ */
+loop_stats_s_t getLoopStats();
+
+/**
+ * Clear the control loop timing statistics
+ */
+void resetLoopStats();
+
 /**
  * initialize the chassis
  */
@@ -82,7 +240,7 @@ void init(std::initializer_list<int8_t> leftMotors,
           std::initializer_list<int8_t> rightMotors, pros::motor_gearset_e_t gearset,
           double slew_step, double linear_exit_error, double angular_exit_error, 
           double settle_thresh_linear, double settle_thresh_angular,
-          int settle_time);
+          int settle_time, int loop_period);
 
 } // namespace arms::chassis
 
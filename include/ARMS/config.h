@@ -7,7 +7,8 @@
 namespace arms {
 
 // Debug
-#define ODOM_DEBUG 0
+#define ODOM_DEBUG 0 // Stream binary telemetry over serial, decode with tools/telemetry.py
+#define RECORD_AUTONOMOUS 0 // Record every autonomous tick to the sd card, convert with tools/recorder.py
 
 // Negative numbers mean reversed motor
 #define LEFT_MOTORS 1, 2
@@ -23,11 +24,29 @@ namespace arms {
 #define MIDDLE_DISTANCE 0     // Distance from middle wheel to the robot turning center
 
 // Sensors
-#define IMU_PORT 0                           // Port 0 for disabled
+#define IMU_PORTS 0                          // Port 0 for disabled, list several to fuse them
 #define ENCODER_PORTS 0, 0, 0                // Port 0 for disabled,
 #define EXPANDER_PORT 0                      // Port 0 for disabled
 #define ENCODER_TYPE arms::odom::ENCODER_ADI // The type of encoders
 
+// Odometry
+#define ODOM_INTEGRATOR arms::odom::INTEGRATOR_ARC // Pose integration method
+#define VELOCITY_FILTER 25   // velocity filter time constant in ms, 0 for none
+#define ESTIMATOR arms::odom::ESTIMATOR_ODOM // Pose estimation method
+#define GPS_PORT 0           // Port 0 for disabled, only used by the EKF. The gps
+                             // reports field coordinates, so odom::reset() must
+                             // place the robot in the field frame
+
+// Localization against the field walls, in field coordinates with the origin
+// at the center of the field. Each sensor is {port, x, y, angle}, with x
+// forward and y left of the turning center in inches, and angle in degrees
+// counterclockwise from the front. Leave empty to disable.
+#define DISTANCE_SENSORS     // {5, 6, 0, 0}, {6, 0, 7, 90}
+#define FIELD_SIZE 140.4     // Distance between opposite field walls in inches
+
+// Control loop
+#define LOOP_PERIOD 10       // control loop period in milliseconds
+
 // Movement tuning
 #define SLEW_STEP 8          // Smaller number = more slew
 #define LINEAR_EXIT_ERROR 1  // default exit distance for linear movements
@@ -45,6 +64,31 @@ namespace arms {
 #define MIN_ERROR 5          // Minimum distance to target before angular componenet is disabled
 #define LEAD_PCT .6			 // Go-to-pose lead distance ratio (0-1)
 
+// Motion profiles for 1D moves and turns, leave the velocity or acceleration
+// at 0 to use PID alone
+#define PROFILE_VELOCITY 0           // inches per second
+#define PROFILE_ACCEL 0              // inches per second squared
+#define PROFILE_JERK 0               // inches per second cubed, 0 for trapezoidal
+#define PROFILE_KV 0                 // feedforward percent per inch per second
+#define PROFILE_KA 0                 // feedforward percent per inch per second squared
+#define PROFILE_ANGULAR_VELOCITY 0   // degrees per second
+#define PROFILE_ANGULAR_ACCEL 0      // degrees per second squared
+#define PROFILE_ANGULAR_JERK 0       // degrees per second cubed, 0 for trapezoidal
+#define PROFILE_ANGULAR_KV 0         // feedforward percent per degree per second
+#define PROFILE_ANGULAR_KA 0         // feedforward percent per degree per second squared
+
+// Path following
+#define LOOKAHEAD 8                  // minimum pure pursuit lookahead in inches
+#define LOOKAHEAD_TIME 0.25          // seconds of travel added to the lookahead
+#define RAMSETE_B 0.0013             // ramsete correction strength, per inch squared
+#define RAMSETE_ZETA 0.7             // ramsete damping between 0 and 1
+
+// Drive feedforward for each side as kS volts, kV volts per inch per second
+// and kA volts per inch per second squared. Leave kV at 0 to use PROFILE_KV
+// and PROFILE_KA instead.
+#define LEFT_FEEDFORWARD 0, 0, 0
+#define RIGHT_FEEDFORWARD 0, 0, 0
+
 // Auton selector configuration constants
 #define AUTONS "Front", "Back", "Do Nothing" // Names of autonomi, up to 10
 #define HUE 0     // Color of theme from 0-359(H part of HSV)
@@ -54,13 +98,23 @@ namespace arms {
 inline void init() {
 
 	chassis::init({LEFT_MOTORS}, {RIGHT_MOTORS}, GEARSET, SLEW_STEP, LINEAR_EXIT_ERROR,
-	              ANGULAR_EXIT_ERROR, SETTLE_THRESH_LINEAR, SETTLE_THRESH_ANGULAR, SETTLE_TIME);
+	              ANGULAR_EXIT_ERROR, SETTLE_THRESH_LINEAR, SETTLE_THRESH_ANGULAR, SETTLE_TIME,
+	              LOOP_PERIOD);
 
-	odom::init(ODOM_DEBUG, ENCODER_TYPE, {ENCODER_PORTS}, EXPANDER_PORT, IMU_PORT,
+	odom::init(ODOM_DEBUG, ENCODER_TYPE, {ENCODER_PORTS}, EXPANDER_PORT, {IMU_PORTS},
 	           TRACK_WIDTH, MIDDLE_DISTANCE, TPI,
-	           MIDDLE_TPI);
+	           MIDDLE_TPI, ODOM_INTEGRATOR, VELOCITY_FILTER, ESTIMATOR, GPS_PORT);
+
+	mcl::init({DISTANCE_SENSORS}, FIELD_SIZE);
+
+	recorder::init(RECORD_AUTONOMOUS);
 
-	pid::init(LINEAR_KP, LINEAR_KI, LINEAR_KD, ANGULAR_KP, ANGULAR_KI, ANGULAR_KD, TRACKING_KP, MIN_ERROR, LEAD_PCT);
+	pid::init(LINEAR_KP, LINEAR_KI, LINEAR_KD, ANGULAR_KP, ANGULAR_KI, ANGULAR_KD, TRACKING_KP, MIN_ERROR, LEAD_PCT,
+	          {PROFILE_VELOCITY, PROFILE_ACCEL, PROFILE_JERK},
+	          {PROFILE_ANGULAR_VELOCITY, PROFILE_ANGULAR_ACCEL, PROFILE_ANGULAR_JERK},
+	          PROFILE_KV, PROFILE_KA, PROFILE_ANGULAR_KV, PROFILE_ANGULAR_KA,
+	          LOOKAHEAD, LOOKAHEAD_TIME, RAMSETE_B, RAMSETE_ZETA,
+	          {LEFT_FEEDFORWARD}, {RIGHT_FEEDFORWARD});
 
 	const char* b[] = {AUTONS, ""};
 	selector::init(HUE, DEFAULT, b);
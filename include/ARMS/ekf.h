@@ -0,0 +1,61 @@
+#ifndef _ARMS_EKF_H_
+#define _ARMS_EKF_H_
+
+#include "ARMS/matrix.h"
+#include "ARMS/point.h"
+
+namespace arms::odom {
+
+/**
+ * Extended Kalman filter estimating the robot pose (x, y, heading).
+ *
+ * Wheel odometry drives the prediction step, and absolute heading (IMU) and
+ * position (GPS) readings correct it. All storage is fixed size and the
+ * filter does not depend on any PROS devices, so it can be fed recorded or
+ * synthetic sensor streams off the robot.
+ */
+class EKF {
+	public:
+	/**
+	 * Set the state and clear the uncertainty
+	 */
+	void reset(Point position, double heading);
+
+	/**
+	 * Advance the state by a robot frame displacement of the turning center
+	 */
+	void predict(double forward, double strafe, double delta_angle);
+
+	/**
+	 * Correct the state with an absolute heading in radians
+	 */
+	void updateHeading(double heading, double variance);
+
+	/**
+	 * Correct the state with an absolute position in inches
+	 */
+	void updatePosition(Point position, double variance);
+
+	/**
+	 * Shift the position and heading estimates without changing their
+	 * uncertainty, the angle in radians
+	 */
+	void translate(Point offset, double angle = 0);
+
+	Point getPosition() const;
+	double getHeading() const;
+
+	private:
+	Matrix<3, 1> x = Matrix<3, 1>::zero();
+	Matrix<3, 3> P = Matrix<3, 3>::zero();
+
+	// process noise, as variance per inch of forward and sideways travel and
+	// per radian of rotation
+	double q_forward = 0.01;
+	double q_strafe = 0.01;
+	double q_angle = 0.001;
+};
+
+} // namespace arms::odom
+
+#endif
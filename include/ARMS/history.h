@@ -0,0 +1,70 @@
+#ifndef _ARMS_HISTORY_H_
+#define _ARMS_HISTORY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace arms {
+
+/**
+ * A fixed capacity record of the last N values written by a single writer,
+ * readable from any task without locks.
+ *
+ * Values are numbered in the order they are written. Each slot carries a
+ * sequence number derived from the number of the value it holds, which is odd
+ * while the slot is being written. A reader checks the sequence before and
+ * after copying a value and simply reports the value as unavailable if it was
+ * overwritten, so readers never wait on the writer. N must be a power of two.
+ */
+template <typename T, std::size_t N> class History {
+	static_assert(N && !(N & (N - 1)), "history capacity must be a power of two");
+
+	public:
+	/**
+	 * Record a value, overwriting the oldest one once full (writer only)
+	 */
+	void push(const T& value) {
+		std::uint32_t h = head.load(std::memory_order_relaxed);
+		Slot& slot = slots[h & (N - 1)];
+		slot.seq.store(2 * h + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.value = value;
+		slot.seq.store(2 * h + 2, std::memory_order_release);
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Return the number of values written so far. The newest value is numbered
+	 * count() - 1 and the oldest still available is count() - N.
+	 */
+	std::uint32_t count() const {
+		return head.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Copy value number i into out, returning false if it has not been written
+	 * yet or has already been overwritten
+	 */
+	bool get(std::uint32_t i, T& out) const {
+		const Slot& slot = slots[i & (N - 1)];
+		if (slot.seq.load(std::memory_order_acquire) != 2 * i + 2)
+			return false;
+		out = slot.value;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot.seq.load(std::memory_order_relaxed) == 2 * i + 2;
+	}
+
+	private:
+	struct Slot {
+		std::atomic<std::uint32_t> seq{0};
+		T value{};
+	};
+
+	Slot slots[N];
+	std::atomic<std::uint32_t> head{0};
+};
+
+} // namespace arms
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef _ARMS_INTEGRATE_H_
+#define _ARMS_INTEGRATE_H_
+
+#include "ARMS/point.h"
+
+namespace arms::odom {
+
+// Pose integrators used by the odometry. Each takes the distance the turning
+// center travelled forward and sideways in the robot frame, the change in
+// heading, and the heading at the end of the step, all in inches and radians,
+// and returns the displacement in the global frame. They do not use any PROS
+// devices, so tools/bench_odom.cpp can compare them off the robot.
+
+/**
+ * Single arc approximation, rotating the chord to the midpoint heading
+ */
+Point integrateArc(double forward, double strafe, double delta_angle,
+                   double heading);
+
+/**
+ * SE(2) exponential map of the body twist
+ */
+Point integrateExp(double forward, double strafe, double delta_angle,
+                   double heading);
+
+/**
+ * Constant heading rate split into midpoint steps
+ */
+Point integrateSubstep(double forward, double strafe, double delta_angle,
+                       double heading);
+
+} // namespace arms::odom
+
+#endif
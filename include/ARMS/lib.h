@@ -1,8 +1,15 @@
 #pragma once
 
+#include "ARMS/characterize.h"
 #include "ARMS/chassis.h"
 #include "ARMS/flags.h"
+#include "ARMS/mcl.h"
 #include "ARMS/odom.h"
+#include "ARMS/path.h"
 #include "ARMS/pid.h"
 #include "ARMS/point.h"
+#include "ARMS/profile.h"
+#include "ARMS/recorder.h"
 #include "ARMS/selector.h"
+#include "ARMS/telemetry.h"
+#include "ARMS/trajectory.h"
@@ -0,0 +1,53 @@
+#ifndef _ARMS_MAILBOX_H_
+#define _ARMS_MAILBOX_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace arms {
+
+/**
+ * A single-producer, single-consumer mailbox that always holds the most
+ * recently posted value.
+ *
+ * Three slots are used so that the producer and consumer each own one while
+ * the third is shared between them. Posting a value fills the producer's slot
+ * and swaps it with the shared slot in one atomic exchange; taking a value
+ * swaps the shared slot with the consumer's. Neither side ever waits on the
+ * other and the consumer can never observe a partially written value.
+ */
+template <typename T> class Mailbox {
+	public:
+	/**
+	 * Publish a value, replacing any value that has not been taken yet
+	 */
+	void post(const T& value) {
+		slots[back] = value;
+		back = state.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	/**
+	 * Copy the newest value into out, returning false if nothing new was posted
+	 * since the last call
+	 */
+	bool take(T& out) {
+		if (!(state.load(std::memory_order_acquire) & FRESH))
+			return false;
+		front = state.exchange(front, std::memory_order_acq_rel) & INDEX;
+		out = slots[front];
+		return true;
+	}
+
+	private:
+	static constexpr std::uint8_t INDEX = 0x3;
+	static constexpr std::uint8_t FRESH = 0x4;
+
+	T slots[3]{};
+	std::atomic<std::uint8_t> state{1}; // shared slot index and fresh flag
+	std::uint8_t back = 0;              // owned by the producer
+	std::uint8_t front = 2;             // owned by the consumer
+};
+
+} // namespace arms
+
+#endif
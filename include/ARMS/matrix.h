@@ -0,0 +1,119 @@
+#ifndef _ARMS_MATRIX_H_
+#define _ARMS_MATRIX_H_
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace arms {
+
+/**
+ * A fixed size, row major matrix of doubles. The dimensions are template
+ * parameters so every matrix lives on the stack or in static storage and the
+ * compiler checks that the shapes of each operation agree.
+ */
+template <std::size_t R, std::size_t C> struct Matrix {
+	double data[R][C];
+
+	static Matrix zero() {
+		Matrix m = {};
+		return m;
+	}
+
+	static Matrix identity() {
+		Matrix m = {};
+		for (std::size_t i = 0; i < R && i < C; i++)
+			m.data[i][i] = 1;
+		return m;
+	}
+
+	double& operator()(std::size_t r, std::size_t c) {
+		return data[r][c];
+	}
+
+	double operator()(std::size_t r, std::size_t c) const {
+		return data[r][c];
+	}
+
+	Matrix operator+(const Matrix& o) const {
+		Matrix m;
+		for (std::size_t i = 0; i < R; i++)
+			for (std::size_t j = 0; j < C; j++)
+				m.data[i][j] = data[i][j] + o.data[i][j];
+		return m;
+	}
+
+	Matrix operator-(const Matrix& o) const {
+		Matrix m;
+		for (std::size_t i = 0; i < R; i++)
+			for (std::size_t j = 0; j < C; j++)
+				m.data[i][j] = data[i][j] - o.data[i][j];
+		return m;
+	}
+
+	template <std::size_t K>
+	Matrix<R, K> operator*(const Matrix<C, K>& o) const {
+		Matrix<R, K> m = {};
+		for (std::size_t i = 0; i < R; i++)
+			for (std::size_t k = 0; k < C; k++)
+				for (std::size_t j = 0; j < K; j++)
+					m.data[i][j] += data[i][k] * o.data[k][j];
+		return m;
+	}
+
+	Matrix<C, R> transpose() const {
+		Matrix<C, R> m;
+		for (std::size_t i = 0; i < R; i++)
+			for (std::size_t j = 0; j < C; j++)
+				m.data[j][i] = data[i][j];
+		return m;
+	}
+};
+
+/**
+ * Invert a square matrix by Gauss-Jordan elimination with partial pivoting.
+ * Returns false and leaves out untouched if the matrix is singular.
+ */
+template <std::size_t N>
+bool invert(const Matrix<N, N>& in, Matrix<N, N>& out) {
+	Matrix<N, N> a = in;
+	Matrix<N, N> inv = Matrix<N, N>::identity();
+
+	for (std::size_t c = 0; c < N; c++) {
+		// pick the largest pivot in this column
+		std::size_t p = c;
+		for (std::size_t r = c + 1; r < N; r++)
+			if (std::fabs(a(r, c)) > std::fabs(a(p, c)))
+				p = r;
+		if (std::fabs(a(p, c)) < 1e-12)
+			return false;
+
+		for (std::size_t j = 0; j < N; j++) {
+			std::swap(a(c, j), a(p, j));
+			std::swap(inv(c, j), inv(p, j));
+		}
+
+		double d = a(c, c);
+		for (std::size_t j = 0; j < N; j++) {
+			a(c, j) /= d;
+			inv(c, j) /= d;
+		}
+
+		for (std::size_t r = 0; r < N; r++) {
+			if (r == c)
+				continue;
+			double f = a(r, c);
+			for (std::size_t j = 0; j < N; j++) {
+				a(r, j) -= f * a(c, j);
+				inv(r, j) -= f * inv(c, j);
+			}
+		}
+	}
+
+	out = inv;
+	return true;
+}
+
+} // namespace arms
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef _ARMS_MCL_H_
+#define _ARMS_MCL_H_
+
+#include "ARMS/point.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace arms::mcl {
+
+// A distance sensor and where it is mounted on the robot
+struct SensorConfig {
+	int port;
+	double x;     // inches forward of the turning center
+	double y;     // inches left of the turning center
+	double angle; // degrees counterclockwise from the front of the robot
+};
+
+// A range reading from a mounted sensor
+struct Reading {
+	float x;     // sensor position in the robot frame, inches
+	float y;
+	float angle; // sensor direction in the robot frame, radians
+	float range; // measured distance, inches
+};
+
+/**
+ * Monte Carlo localization against the field perimeter.
+ *
+ * Each particle is a guess of the robot pose in field coordinates, with the
+ * origin at the center of the field. Particles are moved by the odometry
+ * deltas, weighted by how well the ranges they predict for each distance
+ * sensor match the measured ranges, and resampled when the weights degenerate.
+ * The particles are stored as separate arrays of each component so the hot
+ * loops run straight through contiguous memory without branches. The filter
+ * does not use any PROS devices.
+ */
+class ParticleFilter {
+	public:
+	static constexpr std::size_t PARTICLES = 256;
+
+	/**
+	 * Scatter the particles around a pose
+	 */
+	void init(Point position, double heading, double spread,
+	          double angular_spread, double field_size);
+
+	/**
+	 * Move every particle by a robot frame displacement
+	 */
+	void predict(double forward, double strafe, double delta_angle);
+
+	/**
+	 * Weight the particles by a set of range readings
+	 */
+	void weigh(const Reading* readings, std::size_t count);
+
+	/**
+	 * Draw a new set of particles if the weights have degenerated
+	 */
+	void resample();
+
+	/**
+	 * Return the weighted mean pose and the spread of the particles in inches
+	 */
+	void estimate(Point& position, double& heading, double& spread) const;
+
+	private:
+	float gaussian();
+
+	float x[PARTICLES];
+	float y[PARTICLES];
+	float theta[PARTICLES];
+	float weight[PARTICLES];
+
+	// scratch space so the weighting step does not allocate
+	float cos_theta[PARTICLES];
+	float sin_theta[PARTICLES];
+	float log_weight[PARTICLES];
+
+	float half_field = 72;
+	std::uint32_t seed = 0x2545F491;
+};
+
+/**
+ * Scatter the particles around the current odometry pose on the next update.
+ * This is called by odom::reset().
+ */
+void reset();
+
+/**
+ * Return true if the localization has converged and is correcting odometry
+ */
+bool converged();
+
+/**
+ * Start the localization task. The odometry must already be reset to the
+ * robot's pose in field coordinates, with the origin at the field center.
+ */
+void init(std::initializer_list<SensorConfig> sensors, double field_size);
+
+} // namespace arms::mcl
+
+#endif
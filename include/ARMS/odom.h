@@ -1,13 +1,29 @@
 #ifndef _ARMS_ODOM_H_
 #define _ARMS_ODOM_H_
 
+#include "ARMS/ekf.h"
 #include "ARMS/point.h"
+#include "ARMS/snapshot.h"
 #include <memory>
+#include <vector>
 
 namespace arms::odom {
 
 typedef enum EncoderType { ENCODER_ADI, ENCODER_ROTATION } EncoderType_e_t;
 
+// Pose integration methods
+typedef enum Integrator {
+	INTEGRATOR_ARC,    // single arc, chord rotated to the midpoint heading
+	INTEGRATOR_EXP,    // SE(2) exponential map
+	INTEGRATOR_SUBSTEP // midpoint rule over several sub-steps
+} Integrator_e_t;
+
+// Pose estimation methods
+typedef enum Estimator {
+	ESTIMATOR_ODOM, // integrate the wheels, taking the heading from the imu
+	ESTIMATOR_EKF   // fuse the wheels, imu and gps with a kalman filter
+} Estimator_e_t;
+
 // Odom Configuration
 typedef struct config_data_s {
 	int expanderPort = 0;
@@ -18,24 +34,67 @@ typedef struct config_data_s {
     EncoderType_e_t encoderType;
 } config_data_s_t;
 
-// sensors
+// Robot pose as measured at a point in time
+struct Pose {
+	Point position;     // inches
+	double heading;     // radians, counterclockwise positive
+	std::uint32_t time; // milliseconds since program start
+};
+
+// Robot velocity or acceleration in the robot frame
+struct Twist {
+	double vx;    // forward, inches per second (squared)
+	double vy;    // to the left, inches per second (squared)
+	double omega; // counterclockwise, radians per second (squared)
+};
+
+// sensors, imu is the first of imus
 extern std::shared_ptr<pros::Imu> imu;
+extern std::vector<std::shared_ptr<pros::Imu>> imus;
+extern std::shared_ptr<pros::Gps> gps;
 
 /**
- * Return the left encoder position
+ * Return the left encoder position as of the last odometry update. Without
+ * tracking wheels this combines every left drive motor.
  */
 double getLeftEncoder();
 
 /**
- * Return the right encoder position
+ * Return the right encoder position as of the last odometry update. Without
+ * tracking wheels this combines every right drive motor.
  */
 double getRightEncoder();
 
 /**
- * Return the middle encoder position
+ * Return the middle encoder position as of the last odometry update
  */
 double getMiddleEncoder();
 
+/**
+ * Return a consistent copy of the robot position and heading. This never
+ * blocks the odometry and can be called from any task.
+ */
+Pose getPose();
+
+/**
+ * Return the robot pose at an earlier time in milliseconds, interpolated
+ * between odometry updates. Use this to fuse measurements that arrive late,
+ * such as vision or GPS readings, with the pose the robot had when they were
+ * taken. Times older than the recorded history return the oldest pose, and
+ * future times return the latest. This never blocks.
+ */
+Pose getPoseAt(std::uint32_t time);
+
+/**
+ * Return the filtered robot velocity, measured in the same tick as getPose()
+ */
+Twist getVelocity();
+
+/**
+ * Return the filtered robot acceleration
+ */
+Twist getAcceleration();
+
 /**
  * Return the robot position coordinates
  */
@@ -56,6 +115,12 @@ void reset(Point point = {0, 0});
  */
 void reset(Point point, double angle);
 
+/**
+ * Shift the robot position by an offset and turn the heading by an angle in
+ * degrees, used to correct drift
+ */
+void correct(Point offset, double angle = 0);
+
 /**
  * Return the angle between the robots current heading and a point
  */
@@ -67,11 +132,37 @@ double getAngleError(Point point);
 double getDistanceError(Point point);
 
 /**
- * Initialize the odometry
+ * Sample the sensors and integrate one step of odometry. This is called by the
+ * chassis control loop before the controllers run each tick.
+ */
+void update();
+
+/**
+ * Measure the tracking constants by driving the robot. Start with the robot
+ * square to a wall, facing it from the given distance in inches, with room to
+ * spin. The robot drives slowly into the wall to measure TPI, backs off, and
+ * spins a full turn the given number of times, alternating direction, to fit
+ * the track width and middle wheel distance against the imu by least squares.
+ *
+ * The results are applied immediately, printed, and saved to
+ * /usd/arms_odom.txt, which init() loads over the values in config.h. Delete
+ * the file to go back to the configured values. MIDDLE_TPI can't be measured
+ * on a drive that can't strafe, so the middle distance is fit using the
+ * configured MIDDLE_TPI.
+ */
+void calibrate(double distance, int spins = 4);
+
+/**
+ * Initialize the odometry. With more than one imu the heading is a weighted
+ * fusion of every connected unit, with each unit's drift learned while the
+ * chassis is settled.
  */
 void init(bool debug, EncoderType_e_t encoderType, std::array<int, 3> encoderPorts,
-          int expanderPort, int imuPort, double track_width,
-          double middle_distance, double tpi, double middle_tpi);
+          int expanderPort, std::vector<int> imuPorts, double track_width,
+          double middle_distance, double tpi, double middle_tpi,
+          Integrator_e_t integrator = INTEGRATOR_ARC,
+          double velocity_tc = 25, Estimator_e_t estimator = ESTIMATOR_ODOM,
+          int gpsPort = 0);
 
 } // namespace arms::odom
 
@@ -0,0 +1,86 @@
+#ifndef _ARMS_PATH_H_
+#define _ARMS_PATH_H_
+
+#include "ARMS/point.h"
+#include <vector>
+
+namespace arms {
+
+// A point on a path, looked up by its distance from the start
+struct PathPoint {
+	double distance;  // inches from the start of the path
+	Point position;   // inches
+	double heading;   // radians, the direction of travel
+	double curvature; // radians per inch, counterclockwise positive
+};
+
+/**
+ * A smooth curve through the field, stored as points evenly spaced by arc
+ * length in one contiguous array.
+ *
+ * Building a path integrates the arc length of every segment and resamples
+ * it, so build paths once in initialize() or competition_initialize(). After
+ * that, looking up a point by distance is a constant time interpolation with
+ * no root finding.
+ */
+class Path {
+	public:
+	Path() = default;
+
+	/**
+	 * Return the point at a distance along the path, clamped to its ends
+	 */
+	PathPoint at(double distance) const;
+
+	/**
+	 * Return the length of the path in inches
+	 */
+	double length() const;
+
+	/**
+	 * Return the evenly spaced points of the path
+	 */
+	const std::vector<PathPoint>& getPoints() const;
+
+	protected:
+	// one polynomial piece of the curve
+	struct Segment;
+
+	void build(const std::vector<Segment>& segments);
+
+	std::vector<PathPoint> points;
+	double spacing = 0.5; // inches between points
+};
+
+/**
+ * A chain of cubic Bézier curves. The control points are the start, then two
+ * handles and an end for each curve, so there are 3n + 1 of them.
+ */
+class BezierPath : public Path {
+	public:
+	BezierPath(std::vector<Point> controls);
+};
+
+/**
+ * A curve through every waypoint, leaving each one at its heading with no
+ * sudden change in curvature. Waypoints are {x, y} or {x, y, heading} with
+ * the heading in degrees; where it is missing it is taken from the
+ * neighbouring waypoints.
+ */
+class HermitePath : public Path {
+	public:
+	HermitePath(std::vector<std::vector<double>> waypoints);
+};
+
+/**
+ * A curve through every point, with the direction at each point taken from
+ * its neighbours
+ */
+class CatmullRomPath : public Path {
+	public:
+	CatmullRomPath(std::vector<Point> points);
+};
+
+} // namespace arms
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef _ARMS_PID_H_
 #define _ARMS_PID_H_
 
+#include "ARMS/profile.h"
+#include "ARMS/trajectory.h"
 #include <array>
+#include <memory>
 
 namespace arms::pid {
 
@@ -10,6 +13,8 @@ extern int mode;
 #define DISABLE 0
 #define TRANSLATIONAL 1
 #define ANGULAR 2
+#define FOLLOW 3
+#define RAMSETE 4
 
 // pid constants
 extern double linearKP;
@@ -25,6 +30,10 @@ extern double minError;
 extern double in_lin;
 extern double in_ang;
 
+// errors from the last update, inches and degrees
+extern double linearError;
+extern double angularError;
+
 // targets
 extern double angularTarget;
 extern Point pointTarget;
@@ -35,13 +44,110 @@ extern bool reverse;
 
 extern bool canReverse;
 
+// motion profiles for straight moves and turns, used when their velocity and
+// acceleration limits are set
+extern ProfileConstraints linearConstraints;  // inches
+extern ProfileConstraints angularConstraints; // degrees
+extern double linearKV;  // feedforward, percent per inch per second
+extern double linearKA;  // percent per inch per second squared
+extern double angularKV; // percent per degree per second
+extern double angularKA; // percent per degree per second squared
+extern bool profiled;    // a profile is being followed
+
+/**
+ * Follow a profile for a straight move of the given distance along the
+ * current heading, or a turn by the given angle in degrees, scaling the
+ * velocity limit by max percent. The regular controller takes over once the
+ * profile ends. Cleared by stopProfile() or when a new movement starts.
+ */
+void startLinearProfile(double distance, double max);
+void startAngularProfile(double angle, double max);
+void stopProfile();
+
+// Characterized feedforward for one side of the drive,
+// V = kS sgn(v) + kV v + kA a
+struct Feedforward {
+	double kS; // volts to overcome static friction
+	double kV; // volts per inch per second
+	double kA; // volts per inch per second squared
+
+	bool enabled() const {
+		return kV > 0;
+	}
+
+	// motor speed in percent for a wheel velocity and acceleration
+	double speed(double velocity, double acceleration) const {
+		double sign = velocity > 0 ? 1 : velocity < 0 ? -1 : 0;
+		return (kS * sign + kV * velocity + kA * acceleration) * 100 / 12;
+	}
+};
+
+// drive side feedforward, used by every movement with velocity setpoints
+// when both sides are characterized
+extern Feedforward leftFeedforward;
+extern Feedforward rightFeedforward;
+
+// pure pursuit lookahead, the minimum in inches plus the distance travelled
+// in lookaheadTime seconds at the path velocity
+extern double lookahead;
+extern double lookaheadTime;
+
+/**
+ * Start following a path with pure pursuit
+ */
+void startPursuit(TrajectoryView path);
+
+/**
+ * Return true once the nearest point is the end of the path
+ */
+bool pursuitFinished();
+
+// ramsete gains, b in radians squared per inch squared like a proportional
+// gain, and zeta between 0 and 1 for damping
+extern double ramseteB;
+extern double ramseteZeta;
+
+// Wheel velocity targets for the chassis output stage
+struct WheelTarget {
+	double left;              // inches per second
+	double right;             // inches per second
+	double leftAcceleration;  // inches per second squared
+	double rightAcceleration; // inches per second squared
+};
+
+/**
+ * Set speeds to the motor speeds in percent that drive the wheels at the
+ * target, from the side feedforward. Returns false if the sides have not
+ * been characterized.
+ */
+bool feedforward(const WheelTarget& target, std::array<double, 2>& speeds);
+
+/**
+ * Start tracking a path in time with the ramsete controller
+ */
+void startRamsete(TrajectoryView path);
+
+/**
+ * Return true once the time of the path has run out
+ */
+bool ramseteFinished();
+
 // pid functions
 std::array<double, 2> translational();
 std::array<double, 2> angular();
+std::array<double, 2> pursuit();
+WheelTarget ramsete();
 
 // initializer
 void init(double linearKP, double linearKI, double linearKD, double angularKP,
-          double angularKI, double angularKD, double trackingKP, double minError, double leadPct);
+          double angularKI, double angularKD, double trackingKP, double minError, double leadPct,
+          ProfileConstraints linearConstraints = {},
+          ProfileConstraints angularConstraints = {}, double linearKV = 0,
+          double linearKA = 0, double angularKV = 0, double angularKA = 0,
+          double lookahead = 8, double lookaheadTime = 0.25,
+          double ramseteB = 0.0013, double ramseteZeta = 0.7,
+          Feedforward leftFeedforward = {},
+          Feedforward rightFeedforward = {});
 
 } // namespace arms::pid
 
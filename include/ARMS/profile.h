@@ -0,0 +1,69 @@
+#ifndef _ARMS_PROFILE_H_
+#define _ARMS_PROFILE_H_
+
+namespace arms {
+
+// Limits on a motion profile, in the units of the distance per second. A jerk
+// of 0 gives a trapezoidal profile.
+struct ProfileConstraints {
+	double velocity;
+	double acceleration;
+	double jerk;
+
+	bool enabled() const {
+		return velocity > 0 && acceleration > 0;
+	}
+};
+
+// The setpoint of a profile at one point in time
+struct ProfileState {
+	double position;
+	double velocity;
+	double acceleration;
+};
+
+/**
+ * A one dimensional motion profile from rest to rest.
+ *
+ * With a jerk limit the acceleration ramps up and down linearly, giving an
+ * S-curve; without one the profile is trapezoidal. Moves too short to reach
+ * the velocity limit peak at the fastest velocity that still stops at the
+ * target.
+ */
+class Profile {
+	public:
+	Profile() = default;
+	Profile(double distance, ProfileConstraints constraints);
+
+	/**
+	 * Return the setpoint at t seconds after the start, holding the final
+	 * position after the profile ends
+	 */
+	ProfileState sample(double t) const;
+
+	/**
+	 * Return the length of the profile in seconds
+	 */
+	double duration() const;
+
+	private:
+	// one side of the profile, from rest up to the cruise velocity
+	void setCruise(double v);
+	double rampDistance() const;
+	ProfileState ramp(double t) const;
+
+	double distance = 0; // unsigned
+	double sign = 1;
+	double cruise = 0;   // cruise velocity
+	double jerk = 0;
+	double peak = 0;     // peak acceleration
+	double tj = 0;       // time spent changing acceleration
+	double tc = 0;       // time at constant acceleration
+	double ta = 0;       // time to reach the cruise velocity
+	double tv = 0;       // time at the cruise velocity
+	double maxAcceleration = 0;
+};
+
+} // namespace arms
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef _ARMS_RECORDER_H_
+#define _ARMS_RECORDER_H_
+
+#include <cstdint>
+
+namespace arms::recorder {
+
+// Format version, written in the header of every page
+const std::uint16_t VERSION = 1;
+
+// Size of each block written to the sd card
+const std::uint32_t PAGE_SIZE = 4096;
+
+// Header at the start of every page. The converter in tools/recorder.py reads
+// the record size from here, so records can grow in later versions.
+struct PageHeader {
+	char magic[4];           // "ARMS"
+	std::uint16_t version;   // VERSION
+	std::uint16_t entrySize; // sizeof(Entry)
+	std::uint32_t sequence;  // page number, to detect lost pages
+	std::uint16_t count;     // entries in this page
+	std::uint16_t dropped;   // entries dropped before this page, saturating
+};
+static_assert(sizeof(PageHeader) == 16, "page headers must not be padded");
+
+// One control loop tick
+struct Entry {
+	std::uint32_t time;     // milliseconds since program start
+	float x;                // inches
+	float y;                // inches
+	float heading;          // degrees, counterclockwise positive
+	float linearError;      // inches
+	float angularError;     // degrees
+	float linearIntegral;   // pid integral accumulators
+	float angularIntegral;
+	std::int16_t leftVoltage;  // millivolts sent to the motors
+	std::int16_t rightVoltage; // millivolts sent to the motors
+	std::uint8_t mode;         // chassis mode
+	std::uint8_t exitReason;   // chassis::ExitReason_e_t, set on the tick a
+	                           // movement finishes
+	std::uint16_t command;     // id of the active command, truncated
+};
+static_assert(sizeof(Entry) == 40, "recorder entries must not be padded");
+
+// Number of entries that fit in a page
+const std::uint32_t PAGE_ENTRIES = (PAGE_SIZE - sizeof(PageHeader)) / sizeof(Entry);
+
+/**
+ * Add an entry to the current page. This never blocks on the sd card: when
+ * both pages are waiting to be written the entry is dropped and counted. Only
+ * the chassis control task may call this.
+ */
+void push(const Entry& entry);
+
+/**
+ * Return true if entries are being recorded
+ */
+bool enabled();
+
+/**
+ * Start recording to the next free /usd/arms_NNN.bin file
+ */
+void start();
+
+/**
+ * Stop recording, writing out the last partial page
+ */
+void stop();
+
+/**
+ * Start the background writer. With autonomous set, every autonomous period
+ * is recorded to its own file without calling start() and stop().
+ */
+void init(bool autonomous);
+
+} // namespace arms::recorder
+
+#endif
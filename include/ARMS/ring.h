@@ -0,0 +1,70 @@
+#ifndef _ARMS_RING_H_
+#define _ARMS_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace arms {
+
+/**
+ * A fixed capacity single-producer, single-consumer FIFO queue.
+ *
+ * The producer only writes the head index and the consumer only writes the
+ * tail index, so pushing and popping never lock or allocate. A push fails
+ * instead of blocking when the ring is full. N must be a power of two.
+ */
+template <typename T, std::size_t N> class Ring {
+	static_assert(N && !(N & (N - 1)), "ring capacity must be a power of two");
+
+	public:
+	/**
+	 * Append a value, returning false if the ring is full (producer only)
+	 */
+	bool push(const T& value) {
+		std::uint32_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == N)
+			return false;
+		slots[h & (N - 1)] = value;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest value, returning false if the ring is empty (consumer
+	 * only)
+	 */
+	bool pop(T& out) {
+		std::uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire))
+			return false;
+		out = slots[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Discard every queued value (consumer only)
+	 */
+	void clear() {
+		tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	std::size_t size() const {
+		return head.load(std::memory_order_acquire) -
+		       tail.load(std::memory_order_acquire);
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	private:
+	T slots[N]{};
+	std::atomic<std::uint32_t> head{0};
+	std::atomic<std::uint32_t> tail{0};
+};
+
+} // namespace arms
+
+#endif
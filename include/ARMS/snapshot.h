@@ -0,0 +1,56 @@
+#ifndef _ARMS_SNAPSHOT_H_
+#define _ARMS_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace arms {
+
+/**
+ * A value shared between one writer and any number of readers without locks.
+ *
+ * Two copies of the value are kept and a sequence counter selects which one is
+ * safe to read. The writer updates the copies one at a time, bumping the
+ * counter before each, so a reader always copies the value that is not being
+ * modified. A reader only retries if the writer finished an entire update
+ * while the copy was in progress, and a reader that preempts the writer never
+ * has to wait for it. This is the "latch" variant of a seqlock.
+ *
+ * Writers must be serialized by the caller.
+ */
+template <typename T> class Snapshot {
+	public:
+	void write(const T& value) {
+		std::uint32_t s = seq.load(std::memory_order_relaxed);
+
+		// steer readers to the second copy while the first is written
+		seq.store(s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		data[0] = value;
+
+		// and back to the first copy while the second is written
+		std::atomic_thread_fence(std::memory_order_release);
+		seq.store(s + 2, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		data[1] = value;
+	}
+
+	T read() const {
+		T value;
+		std::uint32_t s;
+		do {
+			s = seq.load(std::memory_order_acquire);
+			value = data[s & 1];
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while (s != seq.load(std::memory_order_relaxed));
+		return value;
+	}
+
+	private:
+	std::atomic<std::uint32_t> seq{0};
+	T data[2]{};
+};
+
+} // namespace arms
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef _ARMS_TELEMETRY_H_
+#define _ARMS_TELEMETRY_H_
+
+#include <cstdint>
+
+namespace arms::telemetry {
+
+// Format version, sent at the start of every frame
+const std::uint8_t VERSION = 1;
+
+// One control loop tick. Every field is four or two bytes wide so the layout
+// has no padding and matches the host decoder in tools/telemetry.py.
+struct Record {
+	std::uint32_t time;     // milliseconds since program start
+	std::uint32_t loopTime; // microseconds spent in the tick
+	float x;                // inches
+	float y;                // inches
+	float heading;          // degrees, counterclockwise positive
+	float targetX;          // inches
+	float targetY;          // inches
+	float targetHeading;    // degrees, 361 when there is no heading target
+	float left;             // motor output, percent
+	float right;            // motor output, percent
+	std::uint16_t mode;     // chassis mode
+	std::uint16_t command;  // id of the active command, truncated
+};
+static_assert(sizeof(Record) == 44, "telemetry records must not be padded");
+
+/**
+ * Queue a record to be sent. This never blocks and drops the record if the
+ * queue is full. Only the chassis control task may call this.
+ */
+void push(const Record& record);
+
+/**
+ * Return true if telemetry has been started
+ */
+bool enabled();
+
+/**
+ * Return the number of records dropped because the queue was full
+ */
+std::uint32_t dropped();
+
+/**
+ * Start streaming records over the serial port. This turns off the PROS
+ * stream multiplexing, so the port carries raw COBS frames, each ending in a
+ * zero byte, that tools/telemetry.py converts to CSV.
+ */
+void init();
+
+} // namespace arms::telemetry
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef _ARMS_TRAJECTORY_H_
+#define _ARMS_TRAJECTORY_H_
+
+#include "ARMS/path.h"
+#include "ARMS/point.h"
+#include <cstddef>
+#include <vector>
+
+namespace arms {
+
+// How the waypoints of a trajectory are joined
+typedef enum Spline {
+	SPLINE_CATMULL_ROM, // through every point, ignoring any headings
+	SPLINE_HERMITE      // through every point, leaving at each point's heading
+	                    // with continuous curvature
+} Spline_e_t;
+
+// Kinematic limits of the robot
+struct TrajectoryConstraints {
+	double velocity;     // inches per second
+	double acceleration; // inches per second squared
+	double trackWidth;   // inches, limits the outer wheel speed in turns
+};
+
+// The setpoint of a trajectory at one point in time
+struct TrajectoryState {
+	double time;         // seconds
+	double distance;     // inches along the path
+	Point position;      // inches
+	double heading;      // radians, the direction the robot faces
+	double velocity;     // inches per second, negative when reversed
+	double acceleration; // inches per second squared
+	double curvature;    // radians per inch, counterclockwise positive
+};
+
+/**
+ * A read only view of trajectory states stored elsewhere, such as a
+ * Trajectory or the constexpr arrays written by tools/bake_paths.cpp. The
+ * states must outlive the view.
+ */
+struct TrajectoryView {
+	const TrajectoryState* states;
+	std::size_t count;
+	TrajectoryConstraints constraints;
+
+	/**
+	 * Return the setpoint at t seconds, interpolated between the states and
+	 * held at the ends
+	 */
+	TrajectoryState sample(double t) const;
+
+	/**
+	 * Return the time in seconds to follow the trajectory
+	 */
+	double duration() const;
+};
+
+/**
+ * A path timed so the robot stays within its velocity and acceleration limits
+ * and its outer wheel never exceeds the velocity limit in a turn. The
+ * trajectory starts and ends at rest.
+ *
+ * Waypoints are given like move() targets, {x, y} or {x, y, heading} with the
+ * heading in degrees, and joined with the given spline. Any Path, such as a
+ * BezierPath, can be timed as well.
+ */
+class Trajectory {
+	public:
+	Trajectory() = default;
+	Trajectory(const Path& path, TrajectoryConstraints constraints,
+	           bool reversed = false);
+	Trajectory(std::vector<std::vector<double>> waypoints,
+	           TrajectoryConstraints constraints,
+	           Spline_e_t spline = SPLINE_HERMITE, bool reversed = false);
+
+	/**
+	 * Return the setpoint at t seconds, interpolated between the generated
+	 * states and held at the ends
+	 */
+	TrajectoryState sample(double t) const;
+
+	/**
+	 * Return the time in seconds to follow the trajectory
+	 */
+	double duration() const;
+
+	/**
+	 * Return the generated states, spaced about half an inch apart
+	 */
+	const std::vector<TrajectoryState>& getStates() const;
+
+	/**
+	 * Return the limits the trajectory was generated with
+	 */
+	TrajectoryConstraints getConstraints() const;
+
+	/**
+	 * Return a view of the states, valid while the trajectory exists
+	 */
+	TrajectoryView view() const;
+
+	private:
+	std::vector<TrajectoryState> states;
+	TrajectoryConstraints constraints = {};
+};
+
+} // namespace arms
+
+#endif
@@ -1,8 +1,13 @@
 #include "ARMS/lib.h"
+#include "ARMS/mailbox.h"
+#include "ARMS/ring.h"
 #include "api.h"
+#include "pros/apix.h"
 #include "pros/motors.h"
 
+#include <atomic>
 #include <tuple>
+#include <type_traits>
 
 namespace arms::chassis {
 
@@ -22,6 +27,10 @@ double settle_thresh_linear;
 double settle_thresh_angular;
 int settle_time;
 
+// control loop timing
+int loopPeriod = 10; // milliseconds
+loop_stats_s_t loopStats;
+
 // chassis variables
 double maxSpeed = 100;
 double leftPrev = 0;
@@ -67,6 +76,9 @@ double slew(double target_speed, double step, double current_speed) {
 	if (fabs(current_speed) > fabs(target_speed))
 		step = 200;
 
+	// the slew step is tuned for a 10ms loop
+	step *= loopPeriod / 10.0;
+
 	if (target_speed > current_speed + step)
 		current_speed += step;
 	else if (target_speed < current_speed - step)
@@ -78,105 +90,423 @@ double slew(double target_speed, double step, double current_speed) {
 }
 
 /**************************************************/
-// settling
-bool settled() {
-	// previous position values
-	static Point p_pos = {0, 0};
-	static double p_ang = 0;
+// velocity output
+// convert wheel velocity targets into motor speeds, through the side
+// feedforward when the drive is characterized, the linear feedforward when
+// it is tuned, and in proportion to the velocity limit of the path otherwise
+std::array<double, 2> velocityOutput(const pid::WheelTarget& target,
+                                     double limit) {
+	std::array<double, 2> speeds;
+	if (pid::feedforward(target, speeds))
+		return speeds;
+	if (pid::linearKV > 0)
+		return {target.left * pid::linearKV +
+		            target.leftAcceleration * pid::linearKA,
+		        target.right * pid::linearKV +
+		            target.rightAcceleration * pid::linearKA};
+	if (limit <= 0)
+		return {0, 0};
+	return {target.left / limit * maxSpeed, target.right / limit * maxSpeed};
+}
 
-	static int settle_count = 0;
+/**************************************************/
+// settling
+Point settle_pos = {0, 0};
+double settle_ang = 0;
+int settle_count = 0;
+bool settle_moved = false; // moved past a threshold since the last reset
+
+void resetSettle() {
+	settle_pos = odom::getPosition();
+	settle_ang = odom::getHeading();
+	settle_count = 0;
+	settle_moved = false;
+}
 
-	Point pos = odom::getPosition();
-	double ang = odom::getHeading();
+// called by the control loop once per tick
+void updateSettle() {
+	odom::Pose pose = odom::getPose();
+	Point pos = pose.position;
+	double ang = pose.heading * 180 / M_PI;
 
-	if (fabs(pos.x - p_pos.x) > settle_thresh_linear) {
-		p_pos.x = pos.x;
+	if (fabs(pos.x - settle_pos.x) > settle_thresh_linear) {
+		settle_pos.x = pos.x;
 		settle_count = 0;
-	} else if (fabs(pos.y - p_pos.y) > settle_thresh_linear) {
-		p_pos.y = pos.y;
+		settle_moved = true;
+	} else if (fabs(pos.y - settle_pos.y) > settle_thresh_linear) {
+		settle_pos.y = pos.y;
 		settle_count = 0;
-	} else if (fabs(ang - p_ang) > settle_thresh_angular) {
-		p_ang = ang;
+		settle_moved = true;
+	} else if (fabs(ang - settle_ang) > settle_thresh_angular) {
+		settle_ang = ang;
 		settle_count = 0;
+		settle_moved = true;
 	} else {
-		settle_count += 10;
+		settle_count += loopPeriod;
 	}
+}
 
-	if (settle_count > settle_time)
-		return true;
-	else
-		return false;
+bool settled() {
+	return settle_count > settle_time;
 }
 
-void waitUntilFinished(double exit_error) {
-	pros::delay(400); // minimum movement time
-	switch (pid::mode) {
-	case TRANSLATIONAL:
-		while (odom::getDistanceError(pid::pointTarget) > exit_error &&
-		       !settled()) {
-			pros::delay(10);
+/**************************************************/
+// motion commands
+struct Command {
+	std::uint32_t id; // commands with the same id belong to the same movement
+	int mode;         // TRANSLATIONAL, ANGULAR, FOLLOW, RAMSETE or DISABLE
+	Point pointTarget;    // point to drive to or to face
+	double angularTarget; // degrees, 361 when a movement has no final heading
+	double maxSpeed;
+	double linearKP;
+	double angularKP; // tracking kp for translational movements
+	double exitError;
+	bool relative; // targets are relative to the pose when the command starts
+	bool face;     // turn to face pointTarget
+	bool thru;
+	bool reverse;
+	bool straight; // a 1D move along the starting heading, can be profiled
+	TrajectoryView path; // path to follow, owned by the caller
+	double leftSpeed; // open loop speeds when disabled
+	double rightSpeed;
+	bool external; // characterize() drives the motors instead of the loop
+};
+
+// commands are copied through the mailbox and ring, so they must not own
+// anything that would be freed in the control loop
+static_assert(std::is_trivially_copyable<Command>::value,
+              "commands must be trivially copyable");
+
+Mailbox<Command> mailbox;      // commands that replace everything in progress
+Ring<Command, 32> pending;     // commands that run back to back
+Command issued = {};           // last command issued, owned by the caller
+bool issuedQueued = false;     // owned by the caller
+std::uint32_t nextId = 1;      // owned by the caller
+
+// last movement that met its exit condition or was replaced
+std::atomic<std::uint32_t> finishedId{0};
+std::atomic<std::uint32_t> waiting{0}; // tasks blocked in waitUntilFinished
+pros::c::sem_t finished = nullptr;     // posted once per waiting task
+
+// wake every task blocked in waitUntilFinished so each can check whether its
+// movement is done. A task deleted while waiting, like autonomous when the
+// match ends, stays counted, so the spare posts are drained on the next call
+// instead of piling up
+void signalFinished() {
+	while (pros::c::sem_wait(finished, 0))
+		;
+	for (std::uint32_t i = waiting; i > 0; i--)
+		pros::c::sem_post(finished);
+}
+
+void post(Command command) {
+	issued = command;
+	issuedQueued = false;
+	mailbox.post(command);
+}
+
+void enqueue(Command command) {
+	issued = command;
+	issuedQueued = true;
+	while (!pending.push(command))
+		pros::delay(loopPeriod);
+}
+
+// convert the targets of a command that is starting into absolute ones
+void resolve(Command& command) {
+	odom::Pose pose = odom::getPose();
+	double h = pose.heading; // robot heading in radians
+	double heading = h * 180 / M_PI;
+
+	if (command.mode == TRANSLATIONAL && command.relative) {
+		Point p = pose.position; // robot position
+		double x = command.pointTarget.x;
+		double y = command.pointTarget.y;
+		command.pointTarget = {p.x + x * cos(h) - y * sin(h),
+		                       p.y + x * sin(h) + y * cos(h)};
+		if (command.angularTarget != 361)
+			command.angularTarget += fmod(heading, 360);
+	} else if (command.mode == ANGULAR) {
+		double diff;
+		if (command.face) {
+			Point p = pose.position;
+			diff = atan2(command.pointTarget.y - p.y, command.pointTarget.x - p.x) -
+			       h;
+			while (fabs(diff) > M_PI)
+				diff -= 2 * M_PI * diff / fabs(diff);
+			diff *= 180 / M_PI;
+		} else if (command.relative) {
+			diff = command.angularTarget;
+		} else {
+			double bounded_heading = (int)(heading) % 360;
+			diff = command.angularTarget - bounded_heading;
+			if (diff > 180)
+				diff -= 360;
+			else if (diff < -180)
+				diff += 360;
 		}
+		command.angularTarget = diff + heading;
+	}
+
+	command.relative = false;
+	command.face = false;
+}
+
+// called by the control loop when a command starts or is updated
+void apply(Command& active, Command command) {
+	// the caller only adjusted the exit condition or drive speeds of the
+	// current command, so keep the controller state
+	if (command.id == active.id) {
+		active.exitError = command.exitError;
+		active.leftSpeed = leftDriveSpeed = command.leftSpeed;
+		active.rightSpeed = rightDriveSpeed = command.rightSpeed;
+		return;
+	}
+
+	double distance = command.pointTarget.x; // of a straight move
+	resolve(command);
+	active = command;
+
+	pid::mode = command.mode;
+	maxSpeed = command.maxSpeed;
+	leftDriveSpeed = command.leftSpeed;
+	rightDriveSpeed = command.rightSpeed;
+
+	if (command.mode == TRANSLATIONAL) {
+		pid::pointTarget = command.pointTarget;
+		pid::angularTarget = command.angularTarget;
+		pid::linearKP = command.linearKP;
+		pid::trackingKP = command.angularKP;
+		pid::thru = command.thru;
+		pid::reverse = command.reverse;
+		pid::canReverse = false;
+		pid::in_lin = 0;
+		pid::in_ang = 0;
+	} else if (command.mode == ANGULAR) {
+		pid::angularTarget = command.angularTarget;
+		pid::angularKP = command.angularKP;
+		pid::in_ang = 0;
+	} else if (command.mode == FOLLOW) {
+		pid::startPursuit(command.path);
+	} else if (command.mode == RAMSETE) {
+		pid::startRamsete(command.path);
+	}
+
+	// straight moves and turns follow a motion profile when one is configured
+	pid::stopProfile();
+	if (command.mode == TRANSLATIONAL && command.straight && !command.thru &&
+	    pid::linearConstraints.enabled())
+		pid::startLinearProfile(distance, command.maxSpeed);
+	else if (command.mode == ANGULAR && pid::angularConstraints.enabled())
+		pid::startAngularProfile(command.angularTarget - odom::getHeading(),
+		                         command.maxSpeed);
+
+	// a new movement starts with a fresh settle timer
+	if (command.mode != DISABLE)
+		resetSettle();
+}
+
+// why a command should finish now, or EXIT_NONE if it should keep running
+ExitReason_e_t exitCondition(const Command& command) {
+	// the settle time only counts once the robot has started moving, so a slow
+	// start is not mistaken for having stopped short
+	ExitReason_e_t unmet =
+	    settle_moved && settled() ? EXIT_SETTLED : EXIT_NONE;
+	switch (command.mode) {
+	case TRANSLATIONAL:
+		if (odom::getDistanceError(command.pointTarget) > command.exitError)
+			return unmet;
 
 		// if doing a pose movement, make sure we are at the target theta
-		if (pid::angularTarget != 361) {
-			while (fabs(odom::getHeading() - pid::angularTarget) > exit_error &&
-			       !settled())
-				pros::delay(10);
-		}
+		if (command.angularTarget != 361 &&
+		    fabs(odom::getHeading() - command.angularTarget) > command.exitError)
+			return unmet;
 
-		break;
+		return EXIT_TARGET;
 	case ANGULAR:
-		while (fabs(odom::getHeading() - pid::angularTarget) > exit_error &&
-		       !settled())
-			pros::delay(10);
-		break;
+		if (fabs(odom::getHeading() - command.angularTarget) > command.exitError)
+			return unmet;
+		return EXIT_TARGET;
+	case FOLLOW:
+		if (!pid::pursuitFinished() ||
+		    odom::getDistanceError(command.pointTarget) > command.exitError)
+			return unmet;
+		return EXIT_TARGET;
+	case RAMSETE:
+		if (!pid::ramseteFinished() ||
+		    odom::getDistanceError(command.pointTarget) > command.exitError)
+			return unmet;
+		return EXIT_TARGET;
 	}
+	return EXIT_TARGET;
 }
 
-/**************************************************/
-// 2D movement
-void move(std::vector<double> target, double max, double exit_error, double lp,
-          double ap, MoveFlags flags) {
-	pid::mode = TRANSLATIONAL;
+// called by the control loop at the start of every tick, returns
+// EXIT_REPLACED if an unfinished movement was replaced by a new one
+ExitReason_e_t updateCommand(Command& active) {
+	// commands queued before the newest direct command are replaced by it
+	static std::uint32_t flushed = 0;
+
+	Command command;
+	if (mailbox.take(command)) {
+		bool replaced = command.id != active.id && finishedId != active.id;
+		flushed = command.id;
+
+		// every movement issued before this one has finished or been
+		// replaced, so release the tasks waiting on them
+		if (command.id != active.id) {
+			finishedId = command.id - 1;
+			signalFinished();
+		}
+		apply(active, command);
+		return replaced ? EXIT_REPLACED : EXIT_NONE;
+	}
 
-	double x = target.at(0);
-	double y = target.at(1);
-	double theta =
-	    target.size() == 3 ? fmod(target.at(2), 360) : 361; // setinel value
+	// start the next queued command the tick after the last one finished
+	while (finishedId == active.id && pending.pop(command)) {
+		if ((std::int32_t)(command.id - flushed) > 0) {
+			apply(active, command);
+			break;
+		}
+	}
+	return EXIT_NONE;
+}
+
+// called by the control loop at the end of every tick, returns why the
+// active command finished on this tick
+ExitReason_e_t updateCompletion(const Command& active) {
+	if (finishedId == active.id)
+		return EXIT_NONE;
 
-	if (flags & RELATIVE) {
-		Point p = odom::getPosition();     // robot position
-		double h = odom::getHeading(true); // robot heading in radians
-		double x_new = p.x + x * cos(h) - y * sin(h);
-		double y_new = p.y + x * sin(h) + y * cos(h);
-		x = x_new;
-		y = y_new;
-		if (target.size() == 3)
-			theta += fmod(odom::getHeading(), 360);
+	ExitReason_e_t reason = exitCondition(active);
+	if (reason != EXIT_NONE) {
+		finishedId = active.id;
+		signalFinished();
 	}
+	return reason;
+}
 
-	pid::pointTarget = Point{x, y};
-	pid::angularTarget = theta;
+void waitUntilFinished() {
+	std::uint32_t id = issued.id;
 
-	maxSpeed = max;
-	pid::linearKP = lp;
-	pid::trackingKP = ap;
-	pid::thru = (flags & THRU);
-	pid::reverse = (flags & REVERSE);
-	pid::canReverse = false;
+	// the control loop wakes this task as soon as the exit condition is met or
+	// a later command replaces the movement
+	waiting++;
+	while ((std::int32_t)(finishedId - id) < 0)
+		pros::c::sem_wait(finished, TIMEOUT_MAX);
+	waiting--;
+}
+
+void waitUntilFinished(double exit_error) {
+	// tighten or relax the exit condition of the movement in progress
+	if (!issuedQueued && issued.mode != DISABLE &&
+	    issued.exitError != exit_error) {
+		Command command = issued;
+		command.exitError = exit_error;
+		post(command);
+	}
+
+	waitUntilFinished();
+}
 
-	// reset the integrals
-	pid::in_lin = 0;
-	pid::in_ang = 0;
+// stop the closed loop control after a blocking movement
+void finish(MoveFlags flags) {
+	Command command = {};
+	command.id = nextId++;
+	command.mode = DISABLE;
+	command.maxSpeed = 100;
+	post(command);
+
+	if (!(flags & THRU))
+		chassis::setBrakeMode(pros::E_MOTOR_BRAKE_BRAKE);
+}
+
+// run a command now, replacing anything in progress or queued
+void run(Command command, MoveFlags flags) {
+	post(command);
 
 	if (!(flags & ASYNC)) {
-		waitUntilFinished(exit_error);
-		pid::mode = DISABLE;
-		if (!(flags & THRU))
-			chassis::setBrakeMode(pros::E_MOTOR_BRAKE_BRAKE);
+		waitUntilFinished(command.exitError);
+		finish(flags);
 	}
 }
 
+Command translational(std::vector<double> target, double max,
+                      double exit_error, double lp, double ap,
+                      MoveFlags flags) {
+	Command command = {};
+	command.id = nextId++;
+	command.mode = TRANSLATIONAL;
+	command.pointTarget = Point{target.at(0), target.at(1)};
+	command.angularTarget =
+	    target.size() == 3 ? fmod(target.at(2), 360) : 361; // setinel value
+	command.maxSpeed = max;
+	command.linearKP = lp;
+	command.angularKP = ap;
+	command.exitError = exit_error;
+	command.relative = (flags & RELATIVE);
+	command.thru = (flags & THRU);
+	command.reverse = (flags & REVERSE);
+	return command;
+}
+
+Command straight(double target, double max, double exit_error, double lp,
+                 double ap, MoveFlags flags) {
+	Command command =
+	    translational({target, 0}, max, exit_error, lp, ap, flags | RELATIVE);
+	command.straight = true;
+	return command;
+}
+
+Command angular(double target, double max, double exit_error, double ap,
+                MoveFlags flags) {
+	Command command = {};
+	command.id = nextId++;
+	command.mode = ANGULAR;
+	command.angularTarget = target;
+	command.maxSpeed = max;
+	command.angularKP = ap;
+	command.exitError = exit_error;
+	command.relative = (flags & RELATIVE);
+	return command;
+}
+
+// only ASYNC and THRU apply to trajectories, and both are handled by run()
+Command trajectory(int mode, TrajectoryView path, double max,
+                   double exit_error) {
+	Command command = {};
+	command.id = nextId++;
+	command.mode = mode;
+	command.path = path;
+	if (path.count)
+		command.pointTarget = path.states[path.count - 1].position;
+	command.maxSpeed = max;
+	command.exitError = exit_error;
+	return command;
+}
+
+// the command only refers to the states, so the caller keeps the trajectory
+// alive and the control loop never copies or frees it
+Command trajectory(int mode, const Trajectory& path, double max,
+                   double exit_error) {
+	return trajectory(mode, path.view(), max, exit_error);
+}
+
+Command angular(Point target, double max, double exit_error, double ap,
+                MoveFlags flags) {
+	Command command = angular(0, max, exit_error, ap, flags);
+	command.pointTarget = target;
+	command.face = true;
+	return command;
+}
+
+/**************************************************/
+// 2D movement
+void move(std::vector<double> target, double max, double exit_error, double lp,
+          double ap, MoveFlags flags) {
+	run(translational(target, max, exit_error, lp, ap, flags), flags);
+}
+
 void move(std::vector<double> target, double max, double exit_error,
           MoveFlags flags) {
 	move(target, max, exit_error, -1, -1, flags);
@@ -192,50 +522,28 @@ void move(std::vector<double> target, MoveFlags flags) {
 
 /**************************************************/
 // 1D movement
+void move(double target, double max, double exit_error, double lp, double ap,
+          MoveFlags flags) {
+	run(straight(target, max, exit_error, lp, ap, flags), flags);
+}
+
 void move(double target, double max, double exit_error, MoveFlags flags) {
-	move({target, 0}, max, exit_error, -1, -1, flags | RELATIVE);
+	move(target, max, exit_error, -1, -1, flags);
 }
 
 void move(double target, double max, MoveFlags flags) {
-	move({target, 0}, max, linear_exit_error, -1, -1, flags | RELATIVE);
+	move(target, max, linear_exit_error, -1, -1, flags);
 }
 
 void move(double target, MoveFlags flags) {
-	move({target, 0}, 100, linear_exit_error, -1, -1, flags | RELATIVE);
+	move(target, 100, linear_exit_error, -1, -1, flags);
 }
 
 /**************************************************/
 // rotational movement
 void turn(double target, double max, double exit_error, double ap,
           MoveFlags flags) {
-	pid::mode = ANGULAR;
-
-	double bounded_heading = (int)(odom::getHeading()) % 360;
-
-	double diff = target - bounded_heading;
-
-	if (diff > 180)
-		diff -= 360;
-	else if (diff < -180)
-		diff += 360;
-
-	if (flags & RELATIVE) {
-		diff = target;
-	}
-
-	double true_target = diff + odom::getHeading();
-
-	pid::angularTarget = true_target;
-	maxSpeed = max;
-	pid::angularKP = ap;
-	pid::in_ang = 0; // reset the integral value to zero
-
-	if (!(flags & ASYNC)) {
-		waitUntilFinished(exit_error);
-		pid::mode = DISABLE;
-		if (!(flags & THRU))
-			chassis::setBrakeMode(pros::E_MOTOR_BRAKE_BRAKE);
-	}
+	run(angular(target, max, exit_error, ap, flags), flags);
 }
 
 void turn(double target, double max, double exit_error, MoveFlags flags) {
@@ -254,8 +562,7 @@ void turn(double target, MoveFlags flags) {
 // turn to point
 void turn(Point target, double max, double exit_error, double ap,
           MoveFlags flags) {
-	double angle_error = odom::getAngleError(target);
-	turn(angle_error, max, exit_error, ap, flags);
+	run(angular(target, max, exit_error, ap, flags), flags);
 }
 
 void turn(Point target, double max, double exit_error, MoveFlags flags) {
@@ -270,11 +577,213 @@ void turn(Point target, MoveFlags flags) {
 	turn(target, 100, angular_exit_error, -1, flags);
 }
 
+/**************************************************/
+// path following
+void follow(const Trajectory& path, double max, double exit_error,
+            MoveFlags flags) {
+	run(trajectory(FOLLOW, path, max, exit_error), flags);
+}
+
+void follow(const Trajectory& path, double max, MoveFlags flags) {
+	follow(path, max, linear_exit_error, flags);
+}
+
+void follow(const Trajectory& path, MoveFlags flags) {
+	follow(path, 100, linear_exit_error, flags);
+}
+
+void follow(TrajectoryView path, double max, double exit_error,
+            MoveFlags flags) {
+	run(trajectory(FOLLOW, path, max, exit_error), flags);
+}
+
+void follow(TrajectoryView path, double max, MoveFlags flags) {
+	follow(path, max, linear_exit_error, flags);
+}
+
+void follow(TrajectoryView path, MoveFlags flags) {
+	follow(path, 100, linear_exit_error, flags);
+}
+
+void track(const Trajectory& path, double max, double exit_error,
+           MoveFlags flags) {
+	run(trajectory(RAMSETE, path, max, exit_error), flags);
+}
+
+void track(const Trajectory& path, double max, MoveFlags flags) {
+	track(path, max, linear_exit_error, flags);
+}
+
+void track(const Trajectory& path, MoveFlags flags) {
+	track(path, 100, linear_exit_error, flags);
+}
+
+void track(TrajectoryView path, double max, double exit_error,
+           MoveFlags flags) {
+	run(trajectory(RAMSETE, path, max, exit_error), flags);
+}
+
+void track(TrajectoryView path, double max, MoveFlags flags) {
+	track(path, max, linear_exit_error, flags);
+}
+
+void track(TrajectoryView path, MoveFlags flags) {
+	track(path, 100, linear_exit_error, flags);
+}
+
+/**************************************************/
+// queued movement
+Queue& queue() {
+	static Queue q;
+	return q;
+}
+
+Queue& Queue::move(std::vector<double> target, double max, double exit_error,
+                   double lp, double ap, MoveFlags flags) {
+	enqueue(translational(target, max, exit_error, lp, ap, flags));
+	return *this;
+}
+
+Queue& Queue::move(std::vector<double> target, double max, double exit_error,
+                   MoveFlags flags) {
+	return move(target, max, exit_error, -1, -1, flags);
+}
+
+Queue& Queue::move(std::vector<double> target, double max, MoveFlags flags) {
+	return move(target, max, linear_exit_error, -1, -1, flags);
+}
+
+Queue& Queue::move(std::vector<double> target, MoveFlags flags) {
+	return move(target, 100, linear_exit_error, -1, -1, flags);
+}
+
+Queue& Queue::move(double target, double max, double exit_error, double lp,
+                   double ap, MoveFlags flags) {
+	enqueue(straight(target, max, exit_error, lp, ap, flags));
+	return *this;
+}
+
+Queue& Queue::move(double target, double max, double exit_error,
+                   MoveFlags flags) {
+	return move(target, max, exit_error, -1, -1, flags);
+}
+
+Queue& Queue::move(double target, double max, MoveFlags flags) {
+	return move(target, max, linear_exit_error, -1, -1, flags);
+}
+
+Queue& Queue::move(double target, MoveFlags flags) {
+	return move(target, 100, linear_exit_error, -1, -1, flags);
+}
+
+Queue& Queue::turn(double target, double max, double exit_error, double ap,
+                   MoveFlags flags) {
+	enqueue(angular(target, max, exit_error, ap, flags));
+	return *this;
+}
+
+Queue& Queue::turn(double target, double max, double exit_error,
+                   MoveFlags flags) {
+	return turn(target, max, exit_error, -1, flags);
+}
+
+Queue& Queue::turn(double target, double max, MoveFlags flags) {
+	return turn(target, max, angular_exit_error, -1, flags);
+}
+
+Queue& Queue::turn(double target, MoveFlags flags) {
+	return turn(target, 100, angular_exit_error, -1, flags);
+}
+
+Queue& Queue::turn(Point target, double max, double exit_error, double ap,
+                   MoveFlags flags) {
+	enqueue(angular(target, max, exit_error, ap, flags));
+	return *this;
+}
+
+Queue& Queue::turn(Point target, double max, double exit_error,
+                   MoveFlags flags) {
+	return turn(target, max, exit_error, -1, flags);
+}
+
+Queue& Queue::turn(Point target, double max, MoveFlags flags) {
+	return turn(target, max, angular_exit_error, -1, flags);
+}
+
+Queue& Queue::turn(Point target, MoveFlags flags) {
+	return turn(target, 100, angular_exit_error, -1, flags);
+}
+
+Queue& Queue::follow(const Trajectory& path, double max, double exit_error) {
+	enqueue(trajectory(FOLLOW, path, max, exit_error));
+	return *this;
+}
+
+Queue& Queue::follow(const Trajectory& path, double max) {
+	return follow(path, max, linear_exit_error);
+}
+
+Queue& Queue::follow(const Trajectory& path) {
+	return follow(path, 100, linear_exit_error);
+}
+
+Queue& Queue::follow(TrajectoryView path, double max, double exit_error) {
+	enqueue(trajectory(FOLLOW, path, max, exit_error));
+	return *this;
+}
+
+Queue& Queue::follow(TrajectoryView path, double max) {
+	return follow(path, max, linear_exit_error);
+}
+
+Queue& Queue::follow(TrajectoryView path) {
+	return follow(path, 100, linear_exit_error);
+}
+
+Queue& Queue::track(const Trajectory& path, double max, double exit_error) {
+	enqueue(trajectory(RAMSETE, path, max, exit_error));
+	return *this;
+}
+
+Queue& Queue::track(const Trajectory& path, double max) {
+	return track(path, max, linear_exit_error);
+}
+
+Queue& Queue::track(const Trajectory& path) {
+	return track(path, 100, linear_exit_error);
+}
+
+Queue& Queue::track(TrajectoryView path, double max, double exit_error) {
+	enqueue(trajectory(RAMSETE, path, max, exit_error));
+	return *this;
+}
+
+Queue& Queue::track(TrajectoryView path, double max) {
+	return track(path, max, linear_exit_error);
+}
+
+Queue& Queue::track(TrajectoryView path) {
+	return track(path, 100, linear_exit_error);
+}
+
 /**************************************************/
 // task control
 int chassisTask() {
+	Command active = {};
+	active.mode = DISABLE;
+	active.maxSpeed = 100;
+
+	std::uint32_t now = pros::millis();
 	while (1) {
-		pros::delay(10);
+		std::uint64_t start = pros::micros();
+
+		// pick up the newest motion command
+		ExitReason_e_t exit = updateCommand(active);
+
+		// sample the sensors and update the robot pose before the controllers
+		// run, so every tick acts on the freshest position available
+		odom::update();
+		updateSettle();
 
 		std::array<double, 2> speeds = {0, 0}; // left, right
 
@@ -282,6 +791,11 @@ int chassisTask() {
 			speeds = pid::translational();
 		else if (pid::mode == ANGULAR)
 			speeds = pid::angular();
+		else if (pid::mode == FOLLOW)
+			speeds = pid::pursuit();
+		else if (pid::mode == RAMSETE)
+			speeds = velocityOutput(pid::ramsete(),
+			                        active.path.constraints.velocity);
 		else
 			speeds = {leftDriveSpeed, rightDriveSpeed};
 
@@ -289,14 +803,180 @@ int chassisTask() {
 		speeds[0] = limitSpeed(speeds[0], maxSpeed);
 		speeds[1] = limitSpeed(speeds[1], maxSpeed);
 
-		// slew
-		speeds[0] = slew(speeds[0], slew_step, leftPrev);
-		speeds[1] = slew(speeds[1], slew_step, rightPrev);
+		// slew, unless a motion profile or path is already limiting the
+		// acceleration
+		if (!pid::profiled && pid::mode != FOLLOW && pid::mode != RAMSETE) {
+			speeds[0] = slew(speeds[0], slew_step, leftPrev);
+			speeds[1] = slew(speeds[1], slew_step, rightPrev);
+		}
 
 		// output
-		motorMove(leftMotors, speeds[0], false);
-		motorMove(rightMotors, speeds[1], false);
+		if (!active.external) {
+			motorMove(leftMotors, speeds[0], false);
+			motorMove(rightMotors, speeds[1], false);
+		}
+
+		// signal any waiting task once the movement is complete
+		if (exit == EXIT_NONE)
+			exit = updateCompletion(active);
+		else
+			updateCompletion(active);
+
+		// timing instrumentation
+		std::uint32_t elapsed = pros::micros() - start;
+		loopStats.ticks++;
+		loopStats.last = elapsed;
+		loopStats.total += elapsed;
+		if (elapsed > loopStats.max)
+			loopStats.max = elapsed;
+		if (elapsed > (std::uint32_t)loopPeriod * 1000)
+			loopStats.overruns++;
+
+		if (telemetry::enabled()) {
+			odom::Pose pose = odom::getPose();
+			telemetry::push({pros::millis(), elapsed, (float)pose.position.x,
+			                 (float)pose.position.y,
+			                 (float)(pose.heading * 180 / M_PI),
+			                 (float)pid::pointTarget.x, (float)pid::pointTarget.y,
+			                 (float)pid::angularTarget, (float)speeds[0],
+			                 (float)speeds[1], (std::uint16_t)pid::mode,
+			                 (std::uint16_t)active.id});
+		}
+
+		if (recorder::enabled()) {
+			odom::Pose pose = odom::getPose();
+			recorder::push({pros::millis(), (float)pose.position.x,
+			                (float)pose.position.y,
+			                (float)(pose.heading * 180 / M_PI),
+			                (float)pid::linearError, (float)pid::angularError,
+			                (float)pid::in_lin, (float)pid::in_ang,
+			                (std::int16_t)(leftPrev * 120),
+			                (std::int16_t)(rightPrev * 120),
+			                (std::uint8_t)pid::mode, (std::uint8_t)exit,
+			                (std::uint16_t)active.id});
+		}
+
+		// fixed rate scheduling, measured from the start of the previous tick
+		pros::Task::delay_until(&now, loopPeriod);
+	}
+}
+
+/**************************************************/
+// characterization
+double meanVelocity(std::shared_ptr<pros::Motor_Group> motors) {
+	std::vector<double> velocities = motors->get_actual_velocities();
+	double sum = 0;
+	for (double v : velocities)
+		sum += v;
+	return velocities.empty() ? 0 : sum / velocities.size();
+}
+
+// drive each side at its direction times the ramp rate times the elapsed
+// time, or times the step voltage, until the robot has travelled distance
+// inches, turned angle radians, or run out of voltage or time
+void characterizeTest(std::vector<CharacterizeSample>& samples,
+                      CharacterizeTest_e_t test, double left, double right,
+                      double ramp, double step, double distance,
+                      double angle) {
+	odom::Pose start = odom::getPose();
+	std::uint64_t begin = pros::micros();
+	std::uint32_t now = pros::millis();
+
+	while (samples.size() < samples.capacity()) {
+		double t = (pros::micros() - begin) / 1e6;
+		double volts = ramp > 0 ? ramp * t : step;
+		odom::Pose pose = odom::getPose();
+		Point d = pose.position;
+		d = d - start.position;
+		if (volts > 12 || t > 10 || sqrt(d.x * d.x + d.y * d.y) > distance ||
+		    fabs(pose.heading - start.heading) > angle)
+			break;
+
+		std::int16_t lv = left * volts * 1000;
+		std::int16_t rv = right * volts * 1000;
+		leftMotors->move_voltage(lv);
+		rightMotors->move_voltage(rv);
+
+		CharacterizeSample sample = {};
+		sample.time = t * 1e6;
+		sample.leftVoltage = lv;
+		sample.rightVoltage = rv;
+		sample.leftVelocity = meanVelocity(leftMotors);
+		sample.rightVelocity = meanVelocity(rightMotors);
+		sample.x = pose.position.x;
+		sample.y = pose.position.y;
+		sample.heading = pose.heading;
+		sample.test = test;
+		samples.push_back(sample);
+
+		pros::Task::delay_until(&now, loopPeriod);
+	}
+
+	// coast to a stop before the next test
+	leftMotors->move_voltage(0);
+	rightMotors->move_voltage(0);
+	pros::delay(1500);
+}
+
+void characterize(double distance, double ramp, double step) {
+	// take the motors from the control loop, which keeps updating odometry
+	Command command = {};
+	command.id = nextId++;
+	command.mode = DISABLE;
+	command.maxSpeed = 100;
+	command.external = true;
+	post(command);
+	setBrakeMode(pros::E_MOTOR_BRAKE_COAST);
+	pros::delay(2 * loopPeriod);
+
+	// enough for every test to run until its time limit
+	std::vector<CharacterizeSample> samples;
+	samples.reserve(6 * 10000 / loopPeriod);
+
+	characterizeTest(samples, TEST_QUASISTATIC_FORWARD, 1, 1, ramp, 0,
+	                 distance, INFINITY);
+	characterizeTest(samples, TEST_QUASISTATIC_BACKWARD, -1, -1, ramp, 0,
+	                 distance, INFINITY);
+	characterizeTest(samples, TEST_DYNAMIC_FORWARD, 1, 1, 0, step, distance,
+	                 INFINITY);
+	characterizeTest(samples, TEST_DYNAMIC_BACKWARD, -1, -1, 0, step, distance,
+	                 INFINITY);
+	characterizeTest(samples, TEST_SPIN_LEFT, -1, 1, ramp, 0, INFINITY,
+	                 4 * M_PI);
+	characterizeTest(samples, TEST_SPIN_RIGHT, 1, -1, ramp, 0, INFINITY,
+	                 4 * M_PI);
+
+	// hand the motors back
+	finish(NONE);
+
+	printf("ARMS characterization: %zu samples\n", samples.size());
+	if (!pros::usd::is_installed()) {
+		printf("ARMS characterization: no sd card, nothing saved\n");
+		return;
+	}
+	FILE* file = fopen(CHARACTERIZE_FILE, "wb");
+	if (!file) {
+		printf("ARMS characterization: cannot open %s\n", CHARACTERIZE_FILE);
+		return;
 	}
+	CharacterizeHeader header = {{'A', 'R', 'M', 'S'},
+	                             CHARACTERIZE_VERSION,
+	                             sizeof(CharacterizeSample),
+	                             (std::uint32_t)samples.size(),
+	                             (std::uint32_t)loopPeriod};
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(samples.data(), sizeof(CharacterizeSample), samples.size(), file);
+	fclose(file);
+	printf("ARMS characterization: saved %s\n", CHARACTERIZE_FILE);
+}
+
+loop_stats_s_t getLoopStats() {
+	return loopStats;
+}
+
+void resetLoopStats() {
+	loopStats = {};
+	loopStats.period = loopPeriod;
 }
 
 /**************************************************/
@@ -306,7 +986,7 @@ void init(std::initializer_list<int8_t> leftMotors,
           pros::motor_gearset_e_t gearset, double slew_step,
           double linear_exit_error, double angular_exit_error,
           double settle_thresh_linear, double settle_thresh_angular,
-          int settle_time) {
+          int settle_time, int loop_period) {
 
 	// assign constants
 	chassis::slew_step = slew_step;
@@ -315,6 +995,9 @@ void init(std::initializer_list<int8_t> leftMotors,
 	chassis::settle_thresh_linear = settle_thresh_linear;
 	chassis::settle_thresh_angular = settle_thresh_angular;
 	chassis::settle_time = settle_time;
+	chassis::loopPeriod = loop_period;
+	resetLoopStats();
+	finished = pros::c::sem_create(32, 0);
 
 	// configure chassis motors
 	chassis::leftMotors =
@@ -324,23 +1007,25 @@ void init(std::initializer_list<int8_t> leftMotors,
 	chassis::leftMotors->set_gearing(gearset);
 	chassis::rightMotors->set_gearing(gearset);
 
-	pros::Task chassis_task(chassisTask);
+	pros::Task chassis_task(chassisTask, TASK_PRIORITY_DEFAULT + 1,
+	                        TASK_STACK_DEPTH_DEFAULT, "ARMS Control");
 }
 
 /**************************************************/
 // operator control
 void tank(double left_speed, double right_speed, bool velocity) {
-	pid::mode = DISABLE; // turns off autonomous tasks
-	maxSpeed = 100;
-	chassis::leftDriveSpeed = left_speed;
-	chassis::rightDriveSpeed = right_speed;
+	// turns off autonomous tasks
+	Command command = {};
+	command.id = issued.mode == DISABLE && !issuedQueued ? issued.id : nextId++;
+	command.mode = DISABLE;
+	command.maxSpeed = 100;
+	command.leftSpeed = left_speed;
+	command.rightSpeed = right_speed;
+	post(command);
 }
 
 void arcade(double vertical, double horizontal, bool velocity) {
-	pid::mode = DISABLE; // turns off autonomous task
-	maxSpeed = 100;
-	chassis::leftDriveSpeed = vertical + horizontal;
-	chassis::rightDriveSpeed = vertical - horizontal;
+	tank(vertical + horizontal, vertical - horizontal, velocity);
 }
 
 } // namespace arms::chassis
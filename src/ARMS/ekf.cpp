@@ -0,0 +1,98 @@
+#include "ARMS/ekf.h"
+
+namespace arms::odom {
+
+// wrap an angle to [-pi, pi]
+static double wrap(double angle) {
+	while (fabs(angle) > M_PI)
+		angle -= 2 * M_PI * angle / fabs(angle);
+	return angle;
+}
+
+void EKF::reset(Point position, double heading) {
+	x(0, 0) = position.x;
+	x(1, 0) = position.y;
+	x(2, 0) = heading;
+	P = Matrix<3, 3>::zero();
+}
+
+void EKF::predict(double forward, double strafe, double delta_angle) {
+	double p = x(2, 0) + delta_angle / 2.0; // midpoint heading
+	double c = cos(p);
+	double s = sin(p);
+
+	// partial derivatives of the displacement with respect to the heading
+	double dx = -s * forward - c * strafe;
+	double dy = c * forward - s * strafe;
+
+	x(0, 0) += c * forward - s * strafe;
+	x(1, 0) += s * forward + c * strafe;
+	x(2, 0) += delta_angle;
+
+	// jacobian of the motion with respect to the state
+	Matrix<3, 3> F = Matrix<3, 3>::identity();
+	F(0, 2) = dx;
+	F(1, 2) = dy;
+
+	// jacobian of the motion with respect to the wheel measurements
+	Matrix<3, 3> G = {{{c, -s, dx / 2.0}, {s, c, dy / 2.0}, {0, 0, 1}}};
+
+	// wheel noise grows with the distance travelled
+	Matrix<3, 3> M = Matrix<3, 3>::zero();
+	M(0, 0) = q_forward * fabs(forward) + 1e-9;
+	M(1, 1) = q_strafe * fabs(strafe) + 1e-9;
+	M(2, 2) = q_angle * fabs(delta_angle) + 1e-9;
+
+	P = F * P * F.transpose() + G * M * G.transpose();
+}
+
+void EKF::updateHeading(double heading, double variance) {
+	// H = [0 0 1], so the gain is the last column of P scaled by 1 / S
+	double S = P(2, 2) + variance;
+	if (S <= 0)
+		return;
+
+	double y = wrap(heading - x(2, 0));
+	Matrix<3, 1> K = {{{P(0, 2) / S}, {P(1, 2) / S}, {P(2, 2) / S}}};
+
+	for (int i = 0; i < 3; i++)
+		x(i, 0) += K(i, 0) * y;
+
+	// P = (I - K H) P
+	Matrix<3, 3> KH = Matrix<3, 3>::zero();
+	for (int i = 0; i < 3; i++)
+		KH(i, 2) = K(i, 0);
+	P = (Matrix<3, 3>::identity() - KH) * P;
+}
+
+void EKF::updatePosition(Point position, double variance) {
+	Matrix<2, 3> H = {{{1, 0, 0}, {0, 1, 0}}};
+	Matrix<2, 2> R = Matrix<2, 2>::identity();
+	R(0, 0) = R(1, 1) = variance;
+
+	Matrix<2, 2> S_inv;
+	if (!invert(H * P * H.transpose() + R, S_inv))
+		return;
+
+	Matrix<3, 2> K = P * H.transpose() * S_inv;
+	Matrix<2, 1> y = {{{position.x - x(0, 0)}, {position.y - x(1, 0)}}};
+
+	x = x + K * y;
+	P = (Matrix<3, 3>::identity() - K * H) * P;
+}
+
+void EKF::translate(Point offset, double angle) {
+	x(0, 0) += offset.x;
+	x(1, 0) += offset.y;
+	x(2, 0) += angle;
+}
+
+Point EKF::getPosition() const {
+	return {x(0, 0), x(1, 0)};
+}
+
+double EKF::getHeading() const {
+	return x(2, 0);
+}
+
+} // namespace arms::odom
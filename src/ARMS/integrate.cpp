@@ -0,0 +1,68 @@
+#include "ARMS/integrate.h"
+
+#include <cmath>
+
+namespace arms::odom {
+
+// single arc approximation, rotating the chord to the midpoint heading
+Point integrateArc(double forward, double strafe, double delta_angle,
+                   double heading) {
+	double local_x = forward;
+	double local_y = strafe;
+
+	if (delta_angle) {
+		double i = sin(delta_angle / 2.0) * 2.0 / delta_angle;
+		local_x *= i;
+		local_y *= i;
+	}
+
+	double p = heading - delta_angle / 2.0; // global angle
+
+	return {cos(p) * local_x - sin(p) * local_y,
+	        cos(p) * local_y + sin(p) * local_x};
+}
+
+// SE(2) exponential map of the body twist, expressed in the frame at the start
+// of the step. The series expansions keep small rotations accurate without
+// special casing a zero heading change.
+Point integrateExp(double forward, double strafe, double delta_angle,
+                   double heading) {
+	double t = delta_angle;
+	double t2 = t * t;
+	double a, b; // sin(t) / t and (1 - cos(t)) / t
+	if (fabs(t) < 1e-4) {
+		a = 1.0 - t2 / 6.0;
+		b = t / 2.0 - t * t2 / 24.0;
+	} else {
+		a = sin(t) / t;
+		b = (1.0 - cos(t)) / t;
+	}
+
+	double local_x = a * forward - b * strafe;
+	double local_y = b * forward + a * strafe;
+
+	double p = heading - delta_angle; // heading at the start of the step
+
+	return {cos(p) * local_x - sin(p) * local_y,
+	        cos(p) * local_y + sin(p) * local_x};
+}
+
+// constant heading rate split into midpoint steps, for comparison with the
+// closed form integrators
+Point integrateSubstep(double forward, double strafe, double delta_angle,
+                       double heading) {
+	const int steps = 8;
+	double dx = forward / steps;
+	double dy = strafe / steps;
+	double dt = delta_angle / steps;
+
+	Point d = {0, 0};
+	double p = heading - delta_angle + dt / 2.0;
+	for (int i = 0; i < steps; i++, p += dt) {
+		d.x += cos(p) * dx - sin(p) * dy;
+		d.y += cos(p) * dy + sin(p) * dx;
+	}
+	return d;
+}
+
+} // namespace arms::odom
@@ -0,0 +1,118 @@
+#include "ARMS/lib.h"
+#include "ARMS/mcl.h"
+#include "api.h"
+
+#include <atomic>
+
+namespace arms::mcl {
+
+/**************************************************/
+// localization task
+const int mcl_period = 50;           // milliseconds between updates
+const double correction_gain = 0.2;  // fraction of the error fixed per update
+const double converged_spread = 3;   // inches
+const int converged_ticks = 5;       // updates in a row with readings
+const std::int32_t max_range = 2000; // millimeters, beyond this is unreliable
+
+const std::size_t max_sensors = 8;
+std::array<SensorConfig, max_sensors> configs;
+std::array<std::shared_ptr<pros::Distance>, max_sensors> devices;
+std::size_t sensor_count = 0;
+
+double field_size;
+ParticleFilter filter;
+std::atomic<bool> isConverged{false};
+std::atomic<bool> reseed{true};
+int measured = 0; // updates in a row that weighed readings
+
+bool converged() {
+	return isConverged;
+}
+
+void reset() {
+	reseed = true;
+}
+
+int mclTask() {
+	odom::Pose prev = odom::getPose();
+
+	std::uint32_t now = pros::millis();
+	while (true) {
+		pros::Task::delay_until(&now, mcl_period);
+
+		// start over around the pose the odometry was reset to
+		if (reseed.exchange(false)) {
+			prev = odom::getPose();
+			filter.init(prev.position, prev.heading, 2, 2 * M_PI / 180, field_size);
+			isConverged = false;
+			measured = 0;
+			continue;
+		}
+
+		// move the particles by the odometry change since the last update
+		odom::Pose pose = odom::getPose();
+		double dx = pose.position.x - prev.position.x;
+		double dy = pose.position.y - prev.position.y;
+		double c = cos(prev.heading);
+		double s = sin(prev.heading);
+		filter.predict(c * dx + s * dy, -s * dx + c * dy,
+		               pose.heading - prev.heading);
+		prev = pose;
+
+		Reading readings[max_sensors];
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < sensor_count; i++) {
+			std::int32_t range = devices[i]->get();
+			if (range == PROS_ERR || range <= 0 || range > max_range)
+				continue;
+			readings[count++] = {(float)configs[i].x, (float)configs[i].y,
+			                     (float)(configs[i].angle * M_PI / 180),
+			                     (float)(range / 25.4)};
+		}
+
+		// the spread of the seed says nothing about the pose, so only trust
+		// the particles after several updates that weighed real readings
+		if (count) {
+			filter.weigh(readings, count);
+			filter.resample();
+			measured++;
+		} else {
+			measured = 0;
+		}
+
+		// pull the odometry towards the estimate once the particles agree
+		Point position;
+		double heading, spread;
+		filter.estimate(position, heading, spread);
+		isConverged = measured >= converged_ticks && spread < converged_spread;
+		if (isConverged) {
+			Point offset = (position - pose.position) * correction_gain;
+			double turn =
+			    remainder(heading - pose.heading, 2 * M_PI) * correction_gain;
+			odom::correct(offset, turn * 180 / M_PI);
+			prev.position = prev.position + offset;
+			prev.heading += turn;
+		}
+	}
+}
+
+void init(std::initializer_list<SensorConfig> sensors, double field_size) {
+	mcl::field_size = field_size;
+
+	sensor_count = 0;
+	for (const SensorConfig& config : sensors) {
+		if (sensor_count == max_sensors)
+			break;
+		configs[sensor_count] = config;
+		devices[sensor_count] = std::make_shared<pros::Distance>(config.port);
+		sensor_count++;
+	}
+
+	if (sensor_count == 0)
+		return;
+
+	pros::Task mcl_task(mclTask, TASK_PRIORITY_DEFAULT - 2,
+	                    TASK_STACK_DEPTH_DEFAULT, "ARMS MCL");
+}
+
+} // namespace arms::mcl
@@ -1,12 +1,21 @@
 #include "ARMS/lib.h"
+#include "ARMS/history.h"
+#include "ARMS/integrate.h"
 #include "api.h"
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+
 namespace arms::odom {
 
 config_data_s_t configData;
 
 // sensors
 std::shared_ptr<pros::Imu> imu = nullptr;
+std::vector<std::shared_ptr<pros::Imu>> imus;
+std::shared_ptr<pros::Gps> gps = nullptr;
 std::shared_ptr<pros::Rotation> rightRotation = nullptr;
 std::shared_ptr<pros::Rotation> leftRotation = nullptr;
 std::shared_ptr<pros::Rotation> middleRotation = nullptr;
@@ -17,6 +26,24 @@ std::shared_ptr<pros::ADIEncoder> middleADIEncoder = nullptr;
 // output the odometry data to the terminal
 bool debug;
 
+// set once the sensors have been configured by init()
+bool initialized = false;
+
+// pose integration method
+Integrator_e_t integrator = INTEGRATOR_ARC;
+
+// pose estimation method
+Estimator_e_t estimator = ESTIMATOR_ODOM;
+EKF ekf;
+
+// measurement noise for the ekf
+const double imu_variance = 1e-4;        // radians squared
+const double gps_min_variance = 1.0;     // inches squared
+const double meters_to_inches = 39.3701;
+
+// last gps reading fused, the gps refreshes slower than the odometry
+Point fused_gps = {NAN, NAN};
+
 // tracker wheel configuration
 double track_width;
 double left_right_distance;
@@ -24,145 +51,507 @@ double middle_distance;
 double tpi;
 double middle_tpi;
 
-// odom position values
+// odom position values, only modified while holding the state mutex
 Point position;
 double heading;
+Twist velocity;
+Twist acceleration;
+
+// velocity filter time constant in seconds
+double velocity_tc;
+
+// consistent copy of the odom values for readers
+struct State {
+	Pose pose;
+	Twist velocity;
+	Twist acceleration;
+};
+Snapshot<State> snapshot;
+
+// the last 1.28 seconds of poses at the default loop period, for aligning
+// delayed measurements with where the robot was when they were taken
+History<Pose, 128> history;
+
+// serializes the writers of the odometry state
+pros::Mutex& stateMutex() {
+	static pros::Mutex mutex;
+	return mutex;
+}
+
+void publish(std::uint32_t time) {
+	Pose pose = {position, heading, time};
+	snapshot.write({pose, velocity, acceleration});
+	history.push(pose);
+}
 
 // previous values
 double prev_left_pos = 0;
 double prev_right_pos = 0;
 double prev_middle_pos = 0;
 double prev_heading = 0;
+std::uint64_t prev_micros = 0;
+
+// Sensor readings taken at the start of an odometry tick
+struct SensorSample {
+	double left;        // encoder ticks
+	double right;       // encoder ticks
+	double middle;      // encoder ticks
+	double rotation;      // imu rotation in degrees, clockwise positive
+	std::uint32_t time;   // milliseconds
+	std::uint64_t micros; // microseconds, for rate estimates
+	Point gps;            // gps position in inches
+	double gpsError;      // gps rms error in inches, negative when unavailable
+};
+
+// Sensor sources, resolved once by init() so that sampling does not need to
+// check the encoder type or which devices exist
+using Source = double (*)();
+
+double readNone() {
+	return 0;
+}
 
-double getLeftEncoder() {
-	if (configData.encoderType == ENCODER_ADI && leftADIEncoder != nullptr) {
-		return leftADIEncoder->get_value();
-	} else if (leftRotation != nullptr) {
-		return leftRotation->get_position();
+Source readLeft = readNone;
+Source readRight = readNone;
+Source readMiddle = readNone;
+Source readRotation = readNone;
+
+// Every drive motor on one side of the chassis combined into one encoder,
+// used when there are no tracking wheels. Each motor's change since the last
+// sample is combined rather than its absolute position, so a motor that
+// disconnects or reconnects does not make the combined position jump.
+class MotorEncoder {
+	public:
+	void init(std::shared_ptr<pros::Motor_Group> motors) {
+		std::vector<std::uint8_t> p = motors->get_ports();
+		count = std::min(p.size(), ports.size());
+		for (std::size_t i = 0; i < count; i++) {
+			ports[i] = p[i];
+			prev[i] = pros::c::motor_get_position(ports[i]);
+		}
+	}
+
+	double read() {
+		// collect the change of every motor that is connected now and was for
+		// the previous sample
+		std::array<double, 8> deltas;
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			double pos = pros::c::motor_get_position(ports[i]);
+			if (pos == PROS_ERR_F) {
+				prev[i] = PROS_ERR_F;
+				continue;
+			}
+			if (prev[i] != PROS_ERR_F)
+				deltas[n++] = pos - prev[i];
+			prev[i] = pos;
+		}
+
+		if (n == 0)
+			return position;
+
+		// the median rejects a single slipping motor, otherwise use the mean
+		std::sort(deltas.begin(), deltas.begin() + n);
+		if (n >= 3)
+			position += n % 2 ? deltas[n / 2]
+			                  : (deltas[n / 2 - 1] + deltas[n / 2]) / 2;
+		else
+			position += std::accumulate(deltas.begin(), deltas.begin() + n, 0.0) / n;
+
+		return position;
+	}
+
+	private:
+	std::array<std::uint8_t, 8> ports;
+	std::array<double, 8> prev;
+	std::size_t count = 0;
+	double position = 0;
+};
+
+MotorEncoder leftMotorEncoder;
+MotorEncoder rightMotorEncoder;
+
+// Every imu combined into one rotation. Like the motor encoders, each imu's
+// change since the last sample is combined, so a unit that drops out or comes
+// back does not make the rotation jump. While the robot is stationary each
+// unit's drift rate and noise are learned, the drift is removed from its
+// changes, and the changes are weighted by the inverse of the noise.
+class ImuFusion {
+	public:
+	void init(const std::vector<std::shared_ptr<pros::Imu>>& devices) {
+		count = std::min(devices.size(), units.size());
+		for (std::size_t i = 0; i < count; i++)
+			units[i] = {devices[i], PROS_ERR_F, 0, 1};
+		prev_micros = pros::micros();
+	}
+
+	double read() {
+		std::uint64_t now = pros::micros();
+		double dt = (now - prev_micros) / 1e6;
+		prev_micros = now;
+
+		std::array<double, 8> deltas;
+		std::array<double, 8> weights;
+		std::size_t n = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			Unit& u = units[i];
+			double rot = u.device->get_rotation();
+
+			// drop units that are disconnected, recalibrating or past the range
+			// of the gyro, and resume from their next good sample
+			if (rot == PROS_ERR_F || u.device->is_calibrating() ||
+			    fabs(u.device->get_gyro_rate().z) > saturation_rate) {
+				u.prev = PROS_ERR_F;
+				continue;
+			}
+
+			if (u.prev != PROS_ERR_F && dt > 0) {
+				double rate = (rot - u.prev) / dt;
+				if (stationary) {
+					double k = dt / (bias_tc + dt);
+					u.bias += k * (rate - u.bias);
+					double e = rate - u.bias;
+					u.variance += k * (e * e - u.variance);
+					u.variance = std::max(u.variance, min_variance);
+				}
+				deltas[n] = (rate - u.bias) * dt;
+				weights[n] = 1 / u.variance;
+				n++;
+			}
+			u.prev = rot;
+		}
+		healthy = n;
+
+		double sum = 0, total = 0;
+		for (std::size_t i = 0; i < n; i++) {
+			sum += deltas[i] * weights[i];
+			total += weights[i];
+		}
+		if (total > 0)
+			rotation += sum / total;
+		return rotation;
+	}
+
+	void setRotation(double rotation) {
+		this->rotation = rotation;
+	}
+
+	// number of imus that contributed to the last sample
+	std::size_t healthy = 0;
+
+	// set by the odometry when the chassis is settled and the wheels are still
+	bool stationary = false;
+
+	private:
+	struct Unit {
+		std::shared_ptr<pros::Imu> device;
+		double prev;     // last rotation, PROS_ERR_F when unavailable
+		double bias;     // drift in degrees per second
+		double variance; // noise of the rate in degrees squared per second squared
+	};
+
+	const double saturation_rate = 950; // degrees per second, the gyro limit is 1000
+	const double bias_tc = 2;           // seconds
+	const double min_variance = 1e-4;
+
+	std::array<Unit, 8> units;
+	std::size_t count = 0;
+	double rotation = 0;
+	std::uint64_t prev_micros = 0;
+};
+
+ImuFusion imuFusion;
+
+// the most recent sample, for the encoder getters
+Snapshot<SensorSample> latest;
+
+void resolveSources() {
+	if (leftADIEncoder) {
+		readLeft = [] { return (double)leftADIEncoder->get_value(); };
+		readRight = [] { return (double)rightADIEncoder->get_value(); };
+	} else if (leftRotation) {
+		readLeft = [] { return (double)leftRotation->get_position(); };
+		readRight = [] { return (double)rightRotation->get_position(); };
 	} else if (chassis::leftMotors) {
-		return chassis::leftMotors->get_positions()[0];
+		leftMotorEncoder.init(chassis::leftMotors);
+		rightMotorEncoder.init(chassis::rightMotors);
+		readLeft = [] { return leftMotorEncoder.read(); };
+		readRight = [] { return rightMotorEncoder.read(); };
+	}
+
+	if (middleADIEncoder)
+		readMiddle = [] { return (double)middleADIEncoder->get_value(); };
+	else if (middleRotation)
+		readMiddle = [] { return (double)middleRotation->get_position(); };
+
+	if (imu) {
+		imuFusion.init(imus);
+		readRotation = [] { return imuFusion.read(); };
 	}
-	return 0;
 }
 
-double getRightEncoder() {
-	if (configData.encoderType == ENCODER_ADI && rightADIEncoder != nullptr) {
-		return rightADIEncoder->get_value();
-	} else if (rightRotation != nullptr) {
-		return rightRotation->get_position();
-	} else if (chassis::rightMotors) {
-		return chassis::rightMotors->get_positions()[0];
+// only called by the task that owns the odometry state
+SensorSample sample() {
+	SensorSample s = {readLeft(), readRight(), readMiddle(), readRotation(),
+	                  pros::millis(), pros::micros(), {0, 0}, -1};
+	if (gps) {
+		pros::c::gps_status_s_t status = gps->get_status();
+		double error = gps->get_error();
+		if (status.x != PROS_ERR_F && error != PROS_ERR_F) {
+			s.gps = {status.x * meters_to_inches, status.y * meters_to_inches};
+			s.gpsError = error * meters_to_inches;
+		}
 	}
-	return 0;
+	latest.write(s);
+	return s;
+}
+
+double getLeftEncoder() {
+	return latest.read().left;
+}
+
+double getRightEncoder() {
+	return latest.read().right;
 }
 
 double getMiddleEncoder() {
-	if (configData.encoderType == ENCODER_ADI && middleADIEncoder != nullptr) {
-		return middleADIEncoder->get_value();
-	} else if (middleRotation != nullptr) {
-		return middleRotation->get_position();
-	}
-	return 0;
+	return latest.read().middle;
 }
 
-int odomTask() {
-
-	position.x = 0;
-	position.y = 0;
-	heading = 0;
-
-	while (true) {
-		// get positions of each encoder
-		double left_pos = getLeftEncoder();
-		double right_pos = getRightEncoder();
-		double middle_pos = configData.middleEncoderPort ? getMiddleEncoder() : 0;
-
-		// calculate change in each encoder
-		double delta_left = (left_pos - prev_left_pos) / tpi;
-		double delta_right = (right_pos - prev_right_pos) / tpi;
-		double delta_middle = configData.middleEncoderPort
-		                          ? (middle_pos - prev_middle_pos) / middle_tpi
-		                          : 0;
-
-		// calculate new heading
-		double delta_angle;
-		if (imu) {
-			heading = -imu->get_rotation() * M_PI / 180.0;
-			delta_angle = heading - prev_heading;
-		} else {
-			delta_angle = (delta_right - delta_left) / track_width;
+/**************************************************/
+// velocity estimation
 
-			heading += delta_angle;
-		}
+// first order low pass filter
+double lowPass(double prev, double next, double alpha) {
+	return prev + alpha * (next - prev);
+}
 
-		// store previous positions
-		prev_left_pos = left_pos;
-		prev_right_pos = right_pos;
-		prev_middle_pos = middle_pos;
-		prev_heading = heading;
+void updateTwist(double vx, double vy, double omega, double dt) {
+	double alpha = dt / (velocity_tc + dt);
 
-		// calculate local displacement
-		double local_x;
-		double local_y;
+	Twist v = {lowPass(velocity.vx, vx, alpha), lowPass(velocity.vy, vy, alpha),
+	           lowPass(velocity.omega, omega, alpha)};
 
-		if (delta_angle) {
-			double i = sin(delta_angle / 2.0) * 2.0;
-			local_x = (delta_right / delta_angle - left_right_distance) * i;
-			local_y = (delta_middle / delta_angle + middle_distance) * i;
-		} else {
-			local_x = delta_right;
-			local_y = delta_middle;
-		}
+	acceleration = {lowPass(acceleration.vx, (v.vx - velocity.vx) / dt, alpha),
+	                lowPass(acceleration.vy, (v.vy - velocity.vy) / dt, alpha),
+	                lowPass(acceleration.omega,
+	                        (v.omega - velocity.omega) / dt, alpha)};
+	velocity = v;
+}
 
-		double p = heading - delta_angle / 2.0; // global angle
+void update() {
+	// the control loop may start before the sensors are configured
+	if (!initialized)
+		return;
+
+	std::lock_guard<pros::Mutex> lock(stateMutex());
+
+	// get positions of each encoder
+	SensorSample s = sample();
+	double left_pos = s.left;
+	double right_pos = s.right;
+	double middle_pos = s.middle;
+
+	// calculate change in each encoder
+	double delta_left = (left_pos - prev_left_pos) / tpi;
+	double delta_right = (right_pos - prev_right_pos) / tpi;
+	double delta_middle = configData.middleEncoderPort
+	                          ? (middle_pos - prev_middle_pos) / middle_tpi
+	                          : 0;
+
+	// calculate new heading, from the wheels if every imu has dropped out
+	double delta_angle;
+	bool imuHealthy = imu && imuFusion.healthy;
+	if (imuHealthy) {
+		heading = -s.rotation * M_PI / 180.0;
+		delta_angle = heading - prev_heading;
+	} else {
+		delta_angle =
+		    track_width > 0 ? (delta_right - delta_left) / track_width : 0;
+
+		heading += delta_angle;
+
+		// carry the imus along so they resume from the wheel heading
+		if (imu)
+			imuFusion.setRotation(-heading * 180 / M_PI);
+	}
 
+	// store previous positions
+	prev_left_pos = left_pos;
+	prev_right_pos = right_pos;
+	prev_middle_pos = middle_pos;
+	prev_heading = heading;
+
+	// learn the imu drift while the robot is not moving
+	imuFusion.stationary = chassis::settled() && fabs(delta_left) < 1e-3 &&
+	                       fabs(delta_right) < 1e-3 && fabs(delta_middle) < 1e-3;
+
+	// with an ekf and a track width the wheels predict the heading change and
+	// the imu corrects it, rather than the imu replacing it. Without a track
+	// width the imu change is the prediction, and fusing its heading again
+	// would count the same information twice.
+	bool wheelHeading =
+	    estimator == ESTIMATOR_EKF && imuHealthy && track_width > 0;
+	if (wheelHeading)
+		delta_angle = (delta_right - delta_left) / track_width;
+
+	// distance travelled by the turning center along and across the robot
+	double forward = delta_right - left_right_distance * delta_angle;
+	double strafe = delta_middle + middle_distance * delta_angle;
+
+	if (estimator == ESTIMATOR_EKF) {
+		ekf.predict(forward, strafe, delta_angle);
+		if (wheelHeading)
+			ekf.updateHeading(heading, imu_variance / imuFusion.healthy);
+		// fuse each gps reading once, or the filter counts a repeated reading
+		// as new information and becomes overconfident
+		if (s.gpsError >= 0 &&
+		    (s.gps.x != fused_gps.x || s.gps.y != fused_gps.y)) {
+			ekf.updatePosition(s.gps, std::max(s.gpsError * s.gpsError,
+			                                   gps_min_variance));
+			fused_gps = s.gps;
+		}
+		position = ekf.getPosition();
+		heading = ekf.getHeading();
+	} else {
 		// convert to absolute displacement
-		position.x += cos(p) * local_x - sin(p) * local_y;
-		position.y += cos(p) * local_y + sin(p) * local_x;
+		Point d;
+		switch (integrator) {
+		case INTEGRATOR_EXP:
+			d = integrateExp(forward, strafe, delta_angle, heading);
+			break;
+		case INTEGRATOR_SUBSTEP:
+			d = integrateSubstep(forward, strafe, delta_angle, heading);
+			break;
+		default:
+			d = integrateArc(forward, strafe, delta_angle, heading);
+			break;
+		}
+		position.x += d.x;
+		position.y += d.y;
+	}
 
-		if (debug)
-			printf("%.2f, %.2f, %.2f \n", position.x, position.y, getHeading());
+	// estimate the body frame velocity and acceleration from the same deltas
+	double dt = (s.micros - prev_micros) / 1e6;
+	prev_micros = s.micros;
+	if (dt > 0)
+		updateTwist(forward / dt, strafe / dt, delta_angle / dt, dt);
 
-		pros::delay(10);
-	}
+	publish(s.time);
 }
 
 void reset(Point point) {
+	std::lock_guard<pros::Mutex> lock(stateMutex());
 	position.x = point.x;
 	position.y = point.y;
+	ekf.reset(position, heading);
+	fused_gps = {NAN, NAN}; // the reset filter has not seen the current reading
+	publish(pros::millis());
+	mcl::reset();
 }
 
 void reset(Point point, double angle) {
-	reset(point);
+	std::lock_guard<pros::Mutex> lock(stateMutex());
+	position.x = point.x;
+	position.y = point.y;
 	heading = angle * M_PI / 180.0;
 	prev_heading = heading;
+	imuFusion.setRotation(-angle);
+	ekf.reset(position, heading);
+	fused_gps = {NAN, NAN}; // the reset filter has not seen the current reading
+	publish(pros::millis());
+	mcl::reset();
+}
+
+void correct(Point offset, double angle) {
+	std::lock_guard<pros::Mutex> lock(stateMutex());
+	position.x += offset.x;
+	position.y += offset.y;
+
+	// turn the imus too, so the next update carries on from the new heading
+	heading += angle * M_PI / 180.0;
+	prev_heading = heading;
 	if (imu)
-		imu->set_rotation(-angle);
+		imuFusion.setRotation(-heading * 180 / M_PI);
+
+	ekf.translate(offset, angle * M_PI / 180.0);
+	publish(pros::millis());
+}
+
+Pose getPose() {
+	return snapshot.read().pose;
+}
+
+Pose getPoseAt(std::uint32_t time) {
+	std::uint32_t count = history.count();
+	Pose newer, older;
+	if (count == 0 || !history.get(count - 1, newer))
+		return getPose();
+	if ((std::int32_t)(time - newer.time) >= 0)
+		return newer;
+
+	// find the first pose taken after the requested time
+	std::uint32_t lo = count > 128 ? count - 128 : 0;
+	std::uint32_t hi = count - 1;
+	while (lo < hi) {
+		std::uint32_t mid = lo + (hi - lo) / 2;
+		Pose pose;
+		// a slot that can't be read is being overwritten, so it is too old
+		if (!history.get(mid, pose) || (std::int32_t)(pose.time - time) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (!history.get(hi, newer))
+		return getPose();
+	if (hi == 0 || !history.get(hi - 1, older) || newer.time == older.time)
+		return newer; // older than the whole history
+
+	// interpolate between the poses on either side
+	double t = (double)(std::int32_t)(time - older.time) /
+	           (std::int32_t)(newer.time - older.time);
+	double turn = remainder(newer.heading - older.heading, 2 * M_PI);
+	Pose pose;
+	pose.position = older.position + (newer.position - older.position) * t;
+	pose.heading = older.heading + turn * t;
+	pose.time = time;
+	return pose;
+}
+
+Twist getVelocity() {
+	return snapshot.read().velocity;
+}
+
+Twist getAcceleration() {
+	return snapshot.read().acceleration;
 }
 
 Point getPosition() {
-	return position;
+	return snapshot.read().pose.position;
 }
 
 double getHeading(bool radians) {
+	double heading = snapshot.read().pose.heading;
 	if (radians)
 		return heading;
 	return heading * 180 / M_PI;
 }
 
 double getAngleError(Point point) {
+	Pose pose = snapshot.read().pose;
 	double x = point.x;
 	double y = point.y;
 
-	x -= position.x;
-	y -= position.y;
+	x -= pose.position.x;
+	y -= pose.position.y;
 
-	double delta_theta = atan2(y, x) - heading;
+	double delta_theta = atan2(y, x) - pose.heading;
 
 	// if movement is reversed, calculate delta_theta using a 180 degree rotation
 	// of the target point
 	if (pid::reverse) {
-		delta_theta = atan2(-y, -x) - heading;
+		delta_theta = atan2(-y, -x) - pose.heading;
 	}
 
 	while (fabs(delta_theta) > M_PI) {
@@ -173,6 +562,7 @@ double getAngleError(Point point) {
 }
 
 double getDistanceError(Point point) {
+	Point position = snapshot.read().pose.position;
 	double x = point.x;
 	double y = point.y;
 
@@ -181,18 +571,147 @@ double getDistanceError(Point point) {
 	return sqrt(x * x + y * y);
 }
 
+/**************************************************/
+// calibration
+const char* calibration_file = "/usd/arms_odom.txt";
+
+// sensor readings at the start and end of one calibration step
+struct Reading {
+	double left;     // ticks
+	double right;    // ticks
+	double middle;   // ticks
+	double rotation; // imu radians, counterclockwise positive
+};
+
+Reading readSensors() {
+	SensorSample s = latest.read();
+	return {s.left, s.right, s.middle, -s.rotation * M_PI / 180};
+}
+
+// drive until the encoders stop changing, such as against a wall
+void driveUntilStalled(double left, double right, int timeout) {
+	chassis::tank(left, right);
+	pros::delay(500);
+
+	Reading prev = readSensors();
+	for (int t = 500; t < timeout; t += 250) {
+		pros::delay(250);
+		Reading r = readSensors();
+		if (fabs(r.left - prev.left) + fabs(r.right - prev.right) < 2)
+			break;
+		prev = r;
+	}
+	chassis::tank(0, 0);
+	pros::delay(500);
+}
+
+// spin in place until the imu has turned by the requested angle
+void spin(double speed, double angle) {
+	Reading start = readSensors();
+	chassis::tank(-speed, speed);
+	for (int t = 0; t < 10000; t += 10) {
+		if (fabs(readSensors().rotation - start.rotation) >= angle)
+			break;
+		pros::delay(10);
+	}
+	chassis::tank(0, 0);
+	pros::delay(750); // let the imu settle before it is read
+}
+
+void calibrate(double distance, int spins) {
+	// straight into the wall, both wheels travel the known distance
+	Reading start = readSensors();
+	driveUntilStalled(25, 25, 10000);
+	Reading end = readSensors();
+	double fit_tpi = ((end.left - start.left) + (end.right - start.right)) /
+	                 (2 * distance);
+	driveUntilStalled(-25, -25, 1500);
+
+	// in place spins in alternating directions, where the wheel travel and the
+	// middle wheel are proportional to the heading change
+	double fit_track_width = track_width;
+	double fit_middle_distance = middle_distance;
+	if (imu) {
+		double sum_wheels = 0, sum_middle = 0, sum_angles = 0;
+		for (int i = 0; i < spins; i++) {
+			Reading a = readSensors();
+			spin(i % 2 ? -40 : 40, 2 * M_PI);
+			Reading b = readSensors();
+			double angle = b.rotation - a.rotation;
+			double wheels = ((b.right - a.right) - (b.left - a.left)) / fit_tpi;
+			sum_wheels += wheels * angle;
+			sum_middle += (b.middle - a.middle) * angle;
+			sum_angles += angle * angle;
+		}
+
+		// least squares fits through the origin
+		fit_track_width = sum_wheels / sum_angles;
+		if (configData.middleEncoderPort && middle_tpi)
+			fit_middle_distance = -sum_middle / sum_angles / middle_tpi;
+	} else {
+		printf("ARMS calibration: no imu, keeping the track width\n");
+	}
+
+	printf("ARMS calibration: tpi %.3f, track width %.3f, middle distance "
+	       "%.3f\n",
+	       fit_tpi, fit_track_width, fit_middle_distance);
+
+	{
+		std::lock_guard<pros::Mutex> lock(stateMutex());
+		tpi = fit_tpi;
+		track_width = fit_track_width;
+		left_right_distance = fit_track_width / 2;
+		middle_distance = fit_middle_distance;
+	}
+
+	if (!pros::usd::is_installed())
+		return;
+	FILE* file = fopen(calibration_file, "w");
+	if (!file)
+		return;
+	fprintf(file, "tpi %f\ntrack_width %f\nmiddle_distance %f\n", fit_tpi,
+	        fit_track_width, fit_middle_distance);
+	fclose(file);
+}
+
+// replace the configured constants with any saved by calibrate()
+void loadCalibration() {
+	if (!pros::usd::is_installed())
+		return;
+	FILE* file = fopen(calibration_file, "r");
+	if (!file)
+		return;
+
+	char key[32];
+	double value;
+	while (fscanf(file, "%31s %lf", key, &value) == 2) {
+		if (!strcmp(key, "tpi"))
+			tpi = value;
+		else if (!strcmp(key, "track_width"))
+			track_width = value;
+		else if (!strcmp(key, "middle_distance"))
+			middle_distance = value;
+	}
+	left_right_distance = track_width / 2;
+	fclose(file);
+}
+
 void init(bool debug, EncoderType_e_t encoderType,
-          std::array<int, 3> encoderPorts, int expanderPort, int imuPort,
+          std::array<int, 3> encoderPorts, int expanderPort,
+          std::vector<int> imuPorts,
           double track_width, double middle_distance, double tpi,
-          double middle_tpi) {
+          double middle_tpi, Integrator_e_t integrator, double velocity_tc,
+          Estimator_e_t estimator, int gpsPort) {
 	odom::debug = debug;
+	odom::integrator = integrator;
+	odom::estimator = estimator;
+	odom::velocity_tc = velocity_tc / 1000.0;
 	odom::track_width = track_width;
 	odom::left_right_distance = track_width / 2;
 	odom::middle_distance = middle_distance;
 	odom::tpi = tpi;
 	odom::middle_tpi = middle_tpi;
-
-	pros::Task odom_task(odomTask);
+	loadCalibration();
 
 	configData.expanderPort = expanderPort;
 	configData.leftEncoderPort = encoderPorts[0];
@@ -256,13 +775,37 @@ void init(bool debug, EncoderType_e_t encoderType,
 	default:
 		break;
 	}
-	// initialize imu
-	if (imuPort != 0) {
-		imu = std::make_shared<pros::Imu>(imuPort);
-		imu->reset(true);
+	// initialize imus, calibrating them all at once
+	for (int port : imuPorts) {
+		if (port == 0)
+			continue;
+		imus.push_back(std::make_shared<pros::Imu>(port));
+		imus.back()->reset();
 	}
+	if (!imus.empty())
+		imu = imus.front();
+	pros::delay(100);
+	for (auto& unit : imus)
+		while (unit->is_calibrating())
+			pros::delay(10);
+	// initialize gps
+	if (gpsPort != 0)
+		gps = std::make_shared<pros::Gps>(gpsPort);
+	resolveSources();
 	pros::delay(100);
 	reset();
+
+	// prime the previous encoder values so the first update has no jump
+	SensorSample s = sample();
+	prev_left_pos = s.left;
+	prev_right_pos = s.right;
+	prev_middle_pos = s.middle;
+	prev_micros = s.micros;
+	initialized = true;
+
+	// stream the pose from the control loop instead of printing it
+	if (debug)
+		telemetry::init();
 }
 
 } // namespace arms::odom
@@ -0,0 +1,156 @@
+#include "ARMS/mcl.h"
+
+#include <cmath>
+
+namespace arms::mcl {
+
+void ParticleFilter::init(Point position, double heading, double spread,
+                          double angular_spread, double field_size) {
+	half_field = field_size / 2;
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		x[i] = position.x + gaussian() * spread;
+		y[i] = position.y + gaussian() * spread;
+		theta[i] = heading + gaussian() * angular_spread;
+		weight[i] = 1.0f / PARTICLES;
+	}
+}
+
+// approximately normal, from the sum of four uniform numbers
+float ParticleFilter::gaussian() {
+	float sum = 0;
+	for (int i = 0; i < 4; i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		sum += seed * (1.0f / 4294967296.0f);
+	}
+	return (sum - 2.0f) * 1.7320508f;
+}
+
+void ParticleFilter::predict(double forward, double strafe,
+                             double delta_angle) {
+	// odometry error grows with the distance travelled
+	float sf = 0.05f * fabs(forward) + 0.01f;
+	float ss = 0.05f * fabs(strafe) + 0.01f;
+	float sa = 0.05f * fabs(delta_angle) + 0.002f;
+
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		float f = forward + gaussian() * sf;
+		float s = strafe + gaussian() * ss;
+		float c = cosf(theta[i]);
+		float n = sinf(theta[i]);
+		x[i] += c * f - n * s;
+		y[i] += n * f + c * s;
+		theta[i] += delta_angle + gaussian() * sa;
+	}
+}
+
+void ParticleFilter::weigh(const Reading* readings, std::size_t count) {
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		cos_theta[i] = cosf(theta[i]);
+		sin_theta[i] = sinf(theta[i]);
+		log_weight[i] = 0;
+	}
+
+	for (std::size_t r = 0; r < count; r++) {
+		const Reading& reading = readings[r];
+		float ca = cosf(reading.angle);
+		float sa = sinf(reading.angle);
+
+		// sensor noise grows with range, and a floor on the likelihood keeps
+		// game objects in front of the walls from wiping out good particles
+		float sigma = 1.0f + 0.05f * reading.range;
+		float inv_var = 1.0f / (sigma * sigma);
+		const float outlier = 0.05f;
+
+		for (std::size_t i = 0; i < PARTICLES; i++) {
+			float c = cos_theta[i];
+			float s = sin_theta[i];
+
+			// sensor pose in the field
+			float sx = x[i] + c * reading.x - s * reading.y;
+			float sy = y[i] + s * reading.x + c * reading.y;
+			float dx = c * ca - s * sa;
+			float dy = s * ca + c * sa;
+
+			// distance along the ray to the nearest wall of the square field
+			float tx = (copysignf(half_field, dx) - sx) / dx;
+			float ty = (copysignf(half_field, dy) - sy) / dy;
+			float expected = fminf(tx, ty);
+
+			float e = reading.range - expected;
+			log_weight[i] += logf(expf(-0.5f * e * e * inv_var) + outlier);
+		}
+	}
+
+	// scale by the best particle so the weights do not underflow
+	float best = log_weight[0];
+	for (std::size_t i = 1; i < PARTICLES; i++)
+		best = fmaxf(best, log_weight[i]);
+
+	float total = 0;
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		weight[i] *= expf(log_weight[i] - best);
+		total += weight[i];
+	}
+	for (std::size_t i = 0; i < PARTICLES; i++)
+		weight[i] /= total;
+}
+
+void ParticleFilter::resample() {
+	float sum_sq = 0;
+	for (std::size_t i = 0; i < PARTICLES; i++)
+		sum_sq += weight[i] * weight[i];
+
+	// only resample once the effective particle count has halved
+	if (1.0f / sum_sq > PARTICLES / 2)
+		return;
+
+	// low variance resampling into the scratch arrays
+	float step = 1.0f / PARTICLES;
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	float u = seed * (step / 4294967296.0f);
+	float c = weight[0];
+	std::size_t j = 0;
+	for (std::size_t i = 0; i < PARTICLES; i++, u += step) {
+		while (u > c && j < PARTICLES - 1)
+			c += weight[++j];
+		cos_theta[i] = x[j];
+		sin_theta[i] = y[j];
+		log_weight[i] = theta[j];
+	}
+
+	// copy back with a little jitter so duplicates spread out again
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		x[i] = cos_theta[i] + gaussian() * 0.1f;
+		y[i] = sin_theta[i] + gaussian() * 0.1f;
+		theta[i] = log_weight[i] + gaussian() * 0.002f;
+		weight[i] = step;
+	}
+}
+
+void ParticleFilter::estimate(Point& position, double& heading,
+                              double& spread) const {
+	double mx = 0, my = 0, mc = 0, ms = 0;
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		mx += weight[i] * x[i];
+		my += weight[i] * y[i];
+		mc += weight[i] * cosf(theta[i]);
+		ms += weight[i] * sinf(theta[i]);
+	}
+
+	double var = 0;
+	for (std::size_t i = 0; i < PARTICLES; i++) {
+		double dx = x[i] - mx;
+		double dy = y[i] - my;
+		var += weight[i] * (dx * dx + dy * dy);
+	}
+
+	position = {mx, my};
+	heading = atan2(ms, mc);
+	spread = sqrt(var);
+}
+
+} // namespace arms::mcl
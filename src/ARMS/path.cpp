@@ -0,0 +1,203 @@
+#include "ARMS/path.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace arms {
+
+// One polynomial piece of a path, with x and y in powers of a parameter that
+// runs from 0 to 1
+struct Path::Segment {
+	Point c[6];
+	int degree;
+
+	// the kth derivative at u, by Horner's method
+	Point derivative(int k, double u) const {
+		Point r = {0, 0};
+		for (int i = degree; i >= k; i--) {
+			double f = 1;
+			for (int j = 0; j < k; j++)
+				f *= i - j;
+			r = r * u + c[i] * f;
+		}
+		return r;
+	}
+};
+
+double magnitude(Point p) {
+	return std::sqrt(p.x * p.x + p.y * p.y);
+}
+
+/**************************************************/
+// arc length parameterization
+void Path::build(const std::vector<Segment>& segments) {
+	points.clear();
+	if (segments.empty())
+		return;
+
+	// integrate the speed along each segment with 3 point Gauss-Legendre
+	// quadrature over short steps, giving the distance at each parameter
+	const int steps = 64;
+	const double gx[3] = {-0.7745966692414834, 0, 0.7745966692414834};
+	const double gw[3] = {5.0 / 9, 8.0 / 9, 5.0 / 9};
+
+	std::vector<double> distances;
+	std::vector<double> params; // segment index plus parameter
+	distances.reserve(segments.size() * steps + 1);
+	params.reserve(segments.size() * steps + 1);
+	distances.push_back(0);
+	params.push_back(0);
+
+	for (std::size_t i = 0; i < segments.size(); i++) {
+		for (int k = 0; k < steps; k++) {
+			double a = (double)k / steps;
+			double h = 1.0 / steps;
+			double sum = 0;
+			for (int g = 0; g < 3; g++)
+				sum += gw[g] *
+				       magnitude(segments[i].derivative(1, a + h / 2 * (1 + gx[g])));
+			distances.push_back(distances.back() + sum * h / 2);
+			params.push_back(i + a + h);
+		}
+	}
+
+	// resample at even distances, walking the table once
+	double total = distances.back();
+	std::size_t count = (std::size_t)ceil(total / spacing) + 1;
+	points.reserve(count);
+	std::size_t j = 0;
+	for (std::size_t n = 0; n < count; n++) {
+		double s = std::min(n * spacing, total);
+		while (j + 2 < distances.size() && distances[j + 1] < s)
+			j++;
+		double span = distances[j + 1] - distances[j];
+		double f = span > 0 ? (s - distances[j]) / span : 0;
+		double u = params[j] + (params[j + 1] - params[j]) * f;
+
+		std::size_t i = std::min((std::size_t)u, segments.size() - 1);
+		double t = u - i;
+		Point d = segments[i].derivative(1, t);
+		Point dd = segments[i].derivative(2, t);
+		double speed = magnitude(d);
+
+		PathPoint p;
+		p.distance = s;
+		p.position = segments[i].derivative(0, t);
+		p.heading = atan2(d.y, d.x);
+		p.curvature =
+		    speed > 1e-9 ? (d.x * dd.y - d.y * dd.x) / (speed * speed * speed) : 0;
+		points.push_back(p);
+	}
+}
+
+PathPoint Path::at(double distance) const {
+	if (points.empty())
+		return {};
+	if (distance <= 0)
+		return points.front();
+	if (distance >= points.back().distance)
+		return points.back();
+
+	std::size_t i = std::min((std::size_t)(distance / spacing), points.size() - 2);
+	const PathPoint& a = points[i];
+	const PathPoint& b = points[i + 1];
+	double f = (distance - a.distance) / (b.distance - a.distance);
+
+	PathPoint p;
+	Point pa = a.position;
+	Point pb = b.position;
+	p.distance = distance;
+	p.position = pa + (pb - pa) * f;
+	p.heading = a.heading + remainder(b.heading - a.heading, 2 * M_PI) * f;
+	p.curvature = a.curvature + (b.curvature - a.curvature) * f;
+	return p;
+}
+
+double Path::length() const {
+	return points.empty() ? 0 : points.back().distance;
+}
+
+const std::vector<PathPoint>& Path::getPoints() const {
+	return points;
+}
+
+/**************************************************/
+// path types
+BezierPath::BezierPath(std::vector<Point> controls) {
+	std::vector<Segment> segments;
+	for (std::size_t i = 0; i + 3 < controls.size(); i += 3) {
+		Point p0 = controls[i], p1 = controls[i + 1];
+		Point p2 = controls[i + 2], p3 = controls[i + 3];
+		Segment s = {};
+		s.degree = 3;
+		s.c[0] = p0;
+		s.c[1] = 3 * (p1 - p0);
+		s.c[2] = 3 * (p0 - 2 * p1 + p2);
+		s.c[3] = (3 * p1 - 3 * p2) + (p3 - p0);
+		segments.push_back(s);
+	}
+	build(segments);
+}
+
+// catmull-rom tangents from the neighbouring points
+std::vector<Point> tangents(const std::vector<Point>& points) {
+	std::size_t n = points.size();
+	std::vector<Point> m(n);
+	for (std::size_t i = 0; i < n; i++) {
+		Point prev = points[i ? i - 1 : i];
+		Point next = points[i + 1 < n ? i + 1 : i];
+		m[i] = next - prev;
+		if (i > 0 && i + 1 < n)
+			m[i] = m[i] / 2;
+	}
+	return m;
+}
+
+HermitePath::HermitePath(std::vector<std::vector<double>> waypoints) {
+	std::vector<Point> p;
+	for (const std::vector<double>& w : waypoints)
+		p.push_back({w.at(0), w.at(1)});
+
+	// point the tangents along the headings, keeping the catmull-rom lengths
+	std::vector<Point> v = tangents(p);
+	for (std::size_t i = 0; i < p.size(); i++) {
+		if (waypoints[i].size() > 2) {
+			double h = waypoints[i][2] * M_PI / 180;
+			v[i] = Point{cos(h), sin(h)} * magnitude(v[i]);
+		}
+	}
+
+	// quintic segments with zero second derivative at each waypoint, so the
+	// curvature is continuous through them
+	std::vector<Segment> segments;
+	for (std::size_t i = 0; i + 1 < p.size(); i++) {
+		Point p0 = p[i], p1 = p[i + 1], v0 = v[i], v1 = v[i + 1];
+		Segment s = {};
+		s.degree = 5;
+		s.c[0] = p0;
+		s.c[1] = v0;
+		s.c[3] = 10 * (p1 - p0) - 6 * v0 - 4 * v1;
+		s.c[4] = 15 * (p0 - p1) + 8 * v0 + 7 * v1;
+		s.c[5] = 6 * (p1 - p0) - 3 * v0 - 3 * v1;
+		segments.push_back(s);
+	}
+	build(segments);
+}
+
+CatmullRomPath::CatmullRomPath(std::vector<Point> points) {
+	std::vector<Point> m = tangents(points);
+	std::vector<Segment> segments;
+	for (std::size_t i = 0; i + 1 < points.size(); i++) {
+		Point p0 = points[i], p1 = points[i + 1], m0 = m[i], m1 = m[i + 1];
+		Segment s = {};
+		s.degree = 3;
+		s.c[0] = p0;
+		s.c[1] = m0;
+		s.c[2] = 3 * (p1 - p0) - 2 * m0 - m1;
+		s.c[3] = 2 * (p0 - p1) + m0 + m1;
+		segments.push_back(s);
+	}
+	build(segments);
+}
+
+} // namespace arms
@@ -20,6 +20,10 @@ double leadPct;
 double in_lin;
 double in_ang;
 
+// errors from the last update
+double linearError;
+double angularError;
+
 // kp defaults
 double defaultLinearKP;
 double defaultAngularKP;
@@ -35,17 +39,83 @@ Point pointTarget{0, 0};
 
 bool canReverse;
 
+// motion profiles
+ProfileConstraints linearConstraints;
+ProfileConstraints angularConstraints;
+double linearKV;
+double linearKA;
+double angularKV;
+double angularKA;
+
+// drive side feedforward
+Feedforward leftFeedforward;
+Feedforward rightFeedforward;
+
+bool feedforward(const WheelTarget& target, std::array<double, 2>& speeds) {
+	if (!leftFeedforward.enabled() || !rightFeedforward.enabled())
+		return false;
+	speeds = {leftFeedforward.speed(target.left, target.leftAcceleration),
+	          rightFeedforward.speed(target.right, target.rightAcceleration)};
+	return true;
+}
+
+Profile profile;
+bool profiled = false;
+std::uint32_t profileStart; // milliseconds
+Point profileOrigin;
+double profileHeading; // radians for straight moves, degrees for turns
+
+void startLinearProfile(double distance, double max) {
+	ProfileConstraints c = linearConstraints;
+	c.velocity *= max / 100;
+	odom::Pose pose = odom::getPose();
+	profile = Profile(distance, c);
+	profileOrigin = pose.position;
+	profileHeading = pose.heading;
+	profileStart = pros::millis();
+	profiled = true;
+}
+
+void startAngularProfile(double angle, double max) {
+	ProfileConstraints c = angularConstraints;
+	c.velocity *= max / 100;
+	profile = Profile(angle, c);
+	profileHeading = odom::getHeading();
+	profileStart = pros::millis();
+	profiled = true;
+}
+
+void stopProfile() {
+	profiled = false;
+}
+
+// the setpoint of the running profile, or false once it has finished
+bool profileSetpoint(ProfileState& s) {
+	if (!profiled)
+		return false;
+	double t = (pros::millis() - profileStart) / 1000.0;
+	if (t >= profile.duration()) {
+		profiled = false;
+		return false;
+	}
+	s = profile.sample(t);
+	return true;
+}
+
 double pid(double error, double* pe, double* in, double kp, double ki,
            double kd) {
 
-	double derivative = error - *pe;
+	// the gains are tuned for a 10ms loop, so scale the rate dependent terms
+	double ticks = chassis::loopPeriod / 10.0;
+
+	double derivative = (error - *pe) / ticks;
 	if ((*pe > 0 && error < 0) || (*pe < 0 && error > 0))
 		*in = 0; // remove integral at zero error
 	double speed = error * kp + *in * ki + derivative * kd;
 
 	// only let integral wind up if near the target
 	if (fabs(error) < 15) {
-		*in += error;
+		*in += error * ticks;
 	}
 
 	*pe = error;
@@ -64,6 +134,39 @@ std::array<double, 2> translational() {
 	static double pe_lin = 0;
 	static double pe_ang = 0;
 
+	// follow the profile along the starting heading, holding that heading
+	ProfileState s;
+	if (profileSetpoint(s)) {
+		odom::Pose pose = odom::getPose();
+		Point d = pose.position - profileOrigin;
+		double travelled =
+		    d.x * cos(profileHeading) + d.y * sin(profileHeading);
+		double heading_error = profileHeading - pose.heading;
+
+		if (linearKP == -1)
+			linearKP = defaultLinearKP;
+		if (trackingKP == -1)
+			trackingKP = defaultTrackingKP;
+
+		linearError = s.position - travelled;
+		angularError = heading_error * 180 / M_PI;
+		double correction = linearError * linearKP;
+		double ang_speed =
+		    pid(heading_error, &pe_ang, &in_ang, trackingKP, 0, 0);
+		// keep the previous errors current for when the controller takes over
+		pe_lin = odom::getDistanceError(pointTarget);
+
+		// the feedback only trims the characterized feedforward of each side
+		std::array<double, 2> ff;
+		if (feedforward({s.velocity, s.velocity, s.acceleration, s.acceleration},
+		                ff))
+			return {ff[0] + correction - ang_speed, ff[1] + correction + ang_speed};
+
+		double lin_speed =
+		    s.velocity * linearKV + s.acceleration * linearKA + correction;
+		return {lin_speed - ang_speed, lin_speed + ang_speed};
+	}
+
 	// an angular target > 360 indicates no desired final pose angle
 	bool noPose = (angularTarget > 360);
 
@@ -113,12 +216,14 @@ std::array<double, 2> translational() {
 		if (noPose) {
 			ang_speed =
 			    0; // disable turning when close to the point to prevent spinning
+			angularError = 0;
 		} else {
 			// turn to face the finale pose angle if executing a pose movement
 			double poseError = (angularTarget * M_PI / 180) - odom::getHeading(true);
 			while (fabs(poseError) > M_PI)
 				poseError -= 2 * M_PI * poseError / fabs(poseError);
 			ang_speed = pid(poseError, &pe_ang, &in_ang, trackingKP, 0, 0);
+			angularError = poseError * 180 / M_PI;
 		}
 
 		// reduce the linear speed if the bot is tangent to the target
@@ -132,8 +237,11 @@ std::array<double, 2> translational() {
 		}
 
 		ang_speed = pid(ang_error, &pe_ang, &in_ang, trackingKP, 0, 0);
+		angularError = ang_error * 180 / M_PI;
 	}
 
+	linearError = lin_error;
+
 	// overturn
 	double overturn = fabs(ang_speed) + lin_speed - 100;
 	if (overturn > 0)
@@ -152,15 +260,184 @@ std::array<double, 2> angular() {
 	if (angularKP == -1)
 		angularKP = defaultAngularKP;
 
+	// follow the profile, with the controller correcting the tracking error
+	ProfileState s;
+	if (profileSetpoint(s)) {
+		double sv = odom::getHeading();
+		double setpoint = profileHeading + s.position;
+		linearError = 0;
+		angularError = setpoint - sv;
+		pe = angularTarget - sv; // for when the controller takes over
+		double speed = s.velocity * angularKV + s.acceleration * angularKA +
+		               angularError * angularKP;
+		return {-speed, speed};
+	}
+
 	double sv = odom::getHeading();
 	double speed =
 	    pid(angularTarget, sv, &pe, &in_ang, angularKP, angularKI, angularKD);
+	linearError = 0;
+	angularError = angularTarget - sv;
 	return {-speed, speed}; // clockwise positive
 }
 
+/**************************************************/
+// pure pursuit
+double lookahead;
+double lookaheadTime;
+
+TrajectoryView path = {};
+std::size_t pathIndex;    // nearest state, only moves forward
+std::size_t lookIndex;    // lookahead state, searched from its last position
+double pathPeakVelocity; // for scaling speeds without feedforward
+
+void startPursuit(TrajectoryView path) {
+	pid::path = path;
+	pathIndex = 0;
+	lookIndex = 0;
+	pathPeakVelocity = 0;
+	for (std::size_t i = 0; i < path.count; i++)
+		pathPeakVelocity = fmax(pathPeakVelocity, fabs(path.states[i].velocity));
+}
+
+bool pursuitFinished() {
+	return pathIndex + 1 >= path.count;
+}
+
+std::array<double, 2> pursuit() {
+	const TrajectoryState* states = path.states;
+	std::size_t n = path.count;
+	if (n == 0)
+		return {0, 0};
+
+	odom::Pose pose = odom::getPose();
+	Point p = pose.position;
+	auto distance2 = [&](std::size_t i) {
+		Point d = states[i].position;
+		d = d - p;
+		return d.x * d.x + d.y * d.y;
+	};
+
+	// the nearest state only moves forward, so the search resumes from the
+	// last one and stops as soon as the distance grows
+	while (pathIndex + 1 < n && distance2(pathIndex + 1) <= distance2(pathIndex))
+		pathIndex++;
+	const TrajectoryState& nearest = states[pathIndex];
+
+	// the lookahead point is the given distance further along the path; it
+	// moves back only as far as the lookahead shrinks
+	double l = lookahead + lookaheadTime * fabs(nearest.velocity);
+	if (lookIndex < pathIndex)
+		lookIndex = pathIndex;
+	while (lookIndex > pathIndex && states[lookIndex].distance - nearest.distance > l)
+		lookIndex--;
+	while (lookIndex + 1 < n && states[lookIndex].distance - nearest.distance < l)
+		lookIndex++;
+
+	// curvature of the arc through the lookahead point, tangent to the robot
+	Point d = states[lookIndex].position;
+	d = d - p;
+	double c = cos(pose.heading);
+	double s = sin(pose.heading);
+	double local_x = c * d.x + s * d.y;
+	double local_y = -s * d.x + c * d.y;
+	double l2 = local_x * local_x + local_y * local_y;
+	double curvature = l2 > 1e-6 ? 2 * local_y / l2 : 0;
+
+	// drive at the velocity just ahead of the nearest state, so the robot
+	// leaves the first state where the path is at rest
+	const TrajectoryState& next = states[std::min(pathIndex + 1, n - 1)];
+	double v = next.velocity;
+
+	linearError = states[n - 1].distance - nearest.distance;
+	angularError =
+	    remainder(nearest.heading - pose.heading, 2 * M_PI) * 180 / M_PI;
+
+	double half = path.constraints.trackWidth / 2;
+	double left, right;
+	std::array<double, 2> ff;
+	if (feedforward({v * (1 - curvature * half), v * (1 + curvature * half),
+	                 next.acceleration * (1 - curvature * half),
+	                 next.acceleration * (1 + curvature * half)},
+	                ff)) {
+		left = ff[0];
+		right = ff[1];
+	} else {
+		double speed = linearKV > 0 ? v * linearKV
+		               : pathPeakVelocity > 0
+		                   ? v / pathPeakVelocity * chassis::maxSpeed
+		                   : 0;
+		double turn = speed * curvature * half;
+		left = speed - turn;
+		right = speed + turn;
+	}
+
+	// keep the ratio of the wheel speeds when one saturates
+	double scale = fmax(fabs(left), fabs(right)) / 100;
+	if (scale > 1) {
+		left /= scale;
+		right /= scale;
+	}
+	return {left, right};
+}
+
+/**************************************************/
+// ramsete
+double ramseteB;
+double ramseteZeta;
+
+TrajectoryView reference = {};
+std::uint32_t referenceStart; // milliseconds
+
+void startRamsete(TrajectoryView path) {
+	reference = path;
+	referenceStart = pros::millis();
+}
+
+bool ramseteFinished() {
+	return (pros::millis() - referenceStart) / 1000.0 >= reference.duration();
+}
+
+WheelTarget ramsete() {
+	TrajectoryState r =
+	    reference.sample((pros::millis() - referenceStart) / 1000.0);
+	odom::Pose pose = odom::getPose();
+
+	// error in the robot frame
+	Point d = r.position;
+	d = d - pose.position;
+	double c = cos(pose.heading);
+	double s = sin(pose.heading);
+	double ex = c * d.x + s * d.y;
+	double ey = -s * d.x + c * d.y;
+	double eh = remainder(r.heading - pose.heading, 2 * M_PI);
+
+	// the gain grows with the reference speed, so the correction stays
+	// proportionate from a crawl to full speed
+	double w = r.velocity * r.curvature;
+	double k = 2 * ramseteZeta * sqrt(w * w + ramseteB * r.velocity * r.velocity);
+	double sinc = fabs(eh) < 1e-6 ? 1 : sin(eh) / eh;
+	double v = r.velocity * cos(eh) + k * ex;
+	w += k * eh + ramseteB * r.velocity * sinc * ey;
+
+	linearError = ex;
+	angularError = eh * 180 / M_PI;
+
+	double half = reference.constraints.trackWidth / 2;
+	double turn = r.acceleration * r.curvature * half;
+	return {v - w * half, v + w * half, r.acceleration - turn,
+	        r.acceleration + turn};
+}
+
 void init(double linearKP, double linearKI, double linearKD, double angularKP,
           double angularKI, double angularKD, double trackingKP,
-          double minError, double leadPct) {
+          double minError, double leadPct,
+          ProfileConstraints linearConstraints,
+          ProfileConstraints angularConstraints, double linearKV,
+          double linearKA, double angularKV, double angularKA,
+          double lookahead, double lookaheadTime, double ramseteB,
+          double ramseteZeta, Feedforward leftFeedforward,
+          Feedforward rightFeedforward) {
 
 	pid::defaultLinearKP = linearKP;
 	pid::linearKI = linearKI;
@@ -171,6 +448,18 @@ void init(double linearKP, double linearKI, double linearKD, double angularKP,
 	pid::defaultTrackingKP = trackingKP;
 	pid::minError = minError;
 	pid::leadPct = leadPct;
+	pid::linearConstraints = linearConstraints;
+	pid::angularConstraints = angularConstraints;
+	pid::linearKV = linearKV;
+	pid::linearKA = linearKA;
+	pid::angularKV = angularKV;
+	pid::angularKA = angularKA;
+	pid::lookahead = lookahead;
+	pid::lookaheadTime = lookaheadTime;
+	pid::ramseteB = ramseteB;
+	pid::ramseteZeta = ramseteZeta;
+	pid::leftFeedforward = leftFeedforward;
+	pid::rightFeedforward = rightFeedforward;
 }
 
 } // namespace arms::pid
@@ -0,0 +1,92 @@
+#include "ARMS/profile.h"
+
+#include <cmath>
+
+namespace arms {
+
+Profile::Profile(double distance, ProfileConstraints constraints) {
+	this->distance = fabs(distance);
+	sign = distance < 0 ? -1 : 1;
+	jerk = constraints.jerk > 0 ? constraints.jerk : 0;
+	maxAcceleration = constraints.acceleration;
+	if (this->distance == 0 || !constraints.enabled())
+		return;
+
+	setCruise(constraints.velocity);
+	if (2 * rampDistance() <= this->distance) {
+		tv = (this->distance - 2 * rampDistance()) / cruise;
+		return;
+	}
+
+	// too short to cruise, so find the velocity where the ramps meet
+	double lo = 0;
+	double hi = constraints.velocity;
+	for (int i = 0; i < 50; i++) {
+		double mid = (lo + hi) / 2;
+		setCruise(mid);
+		if (2 * rampDistance() > this->distance)
+			hi = mid;
+		else
+			lo = mid;
+	}
+	setCruise(lo);
+	tv = (this->distance - 2 * rampDistance()) / cruise;
+}
+
+void Profile::setCruise(double v) {
+	cruise = v;
+	peak = jerk ? fmin(maxAcceleration, sqrt(v * jerk)) : maxAcceleration;
+	tj = jerk ? peak / jerk : 0;
+	tc = peak > 0 ? v / peak - tj : 0;
+	ta = tc + 2 * tj;
+}
+
+// the velocity curve of a ramp is symmetric about its midpoint
+double Profile::rampDistance() const {
+	return cruise * ta / 2;
+}
+
+ProfileState Profile::ramp(double t) const {
+	// acceleration increasing
+	if (t < tj)
+		return {jerk * t * t * t / 6, jerk * t * t / 2, jerk * t};
+
+	double x1 = jerk * tj * tj * tj / 6;
+	double v1 = jerk * tj * tj / 2;
+
+	// constant acceleration
+	double u = t - tj;
+	if (u < tc)
+		return {x1 + v1 * u + peak * u * u / 2, v1 + peak * u, peak};
+
+	double x2 = x1 + v1 * tc + peak * tc * tc / 2;
+	double v2 = v1 + peak * tc;
+
+	// acceleration decreasing
+	u = fmin(t - tj - tc, tj);
+	return {x2 + v2 * u + peak * u * u / 2 - jerk * u * u * u / 6,
+	        v2 + peak * u - jerk * u * u / 2, peak - jerk * u};
+}
+
+ProfileState Profile::sample(double t) const {
+	ProfileState s;
+	if (t <= 0) {
+		s = {0, 0, 0};
+	} else if (t >= duration()) {
+		s = {distance, 0, 0};
+	} else if (t < ta) {
+		s = ramp(t);
+	} else if (t < ta + tv) {
+		s = {rampDistance() + cruise * (t - ta), cruise, 0};
+	} else {
+		ProfileState r = ramp(duration() - t);
+		s = {distance - r.position, r.velocity, -r.acceleration};
+	}
+	return {s.position * sign, s.velocity * sign, s.acceleration * sign};
+}
+
+double Profile::duration() const {
+	return cruise > 0 ? 2 * ta + tv : 0;
+}
+
+} // namespace arms
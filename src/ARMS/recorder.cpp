@@ -0,0 +1,168 @@
+#include "ARMS/lib.h"
+#include "api.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace arms::recorder {
+
+struct Page {
+	PageHeader header;
+	Entry entries[PAGE_ENTRIES];
+};
+static_assert(sizeof(Page) == PAGE_SIZE, "pages must fill a block exactly");
+
+// The control task fills one page while the writer task writes the other.
+// full is the index of the page waiting to be written, or -1.
+Page pages[2];
+std::atomic<int> full{-1};
+
+// set by the writer task, read by the control task
+std::atomic<bool> recording{false};
+
+// set by the control task once it has handed over its last page after
+// recording stopped
+std::atomic<bool> idle{true};
+
+// owned by the control task
+int fill = 0;
+bool wasRecording = false;
+std::uint32_t sequence = 0;
+std::uint16_t dropped = 0;
+
+// requests from the user and configuration
+std::atomic<bool> requested{false};
+bool autonomous = false;
+bool started = false;
+
+const int write_period = 20; // milliseconds, 2 pages fill in 2 seconds
+
+// give the filled page to the writer and start the other one
+void handoff() {
+	PageHeader& header = pages[fill].header;
+	header.magic[0] = 'A';
+	header.magic[1] = 'R';
+	header.magic[2] = 'M';
+	header.magic[3] = 'S';
+	header.version = VERSION;
+	header.entrySize = sizeof(Entry);
+	header.sequence = sequence++;
+	header.dropped = dropped;
+	full.store(fill, std::memory_order_release);
+
+	fill ^= 1;
+	pages[fill].header.count = 0;
+}
+
+void push(const Entry& entry) {
+	bool rec = recording.load(std::memory_order_acquire);
+	Page& page = pages[fill];
+
+	// every file starts counting pages from zero
+	if (rec && !wasRecording) {
+		sequence = 0;
+		dropped = 0;
+		page.header.count = 0;
+	}
+	wasRecording = rec;
+
+	// pass on a full page, or the last partial one once recording stops, as
+	// soon as the writer has finished with the other page
+	std::uint16_t count = page.header.count;
+	if ((count == PAGE_ENTRIES || (!rec && count > 0)) &&
+	    full.load(std::memory_order_acquire) == -1)
+		handoff();
+
+	if (rec) {
+		Page& current = pages[fill];
+		if (current.header.count == PAGE_ENTRIES) {
+			if (dropped < UINT16_MAX)
+				dropped++;
+		} else {
+			current.entries[current.header.count++] = entry;
+		}
+	}
+
+	idle.store(!rec && pages[fill].header.count == 0, std::memory_order_release);
+}
+
+bool enabled() {
+	return recording.load(std::memory_order_relaxed) ||
+	       pages[fill].header.count > 0;
+}
+
+void start() {
+	requested = true;
+}
+
+void stop() {
+	requested = false;
+}
+
+// open the first unused log file name
+FILE* open() {
+	if (!pros::usd::is_installed())
+		return nullptr;
+
+	char name[32];
+	for (int i = 0; i < 1000; i++) {
+		snprintf(name, sizeof(name), "/usd/arms_%03d.bin", i);
+		FILE* existing = fopen(name, "rb");
+		if (existing) {
+			fclose(existing);
+			continue;
+		}
+		return fopen(name, "wb");
+	}
+	return nullptr;
+}
+
+int writerTask() {
+	FILE* file = nullptr;
+	bool attempted = false; // only try to open a file once per request
+
+	while (true) {
+		bool want = requested ||
+		            (autonomous && pros::competition::is_autonomous() &&
+		             !pros::competition::is_disabled());
+
+		if (want && !file && !attempted) {
+			attempted = true;
+			file = open();
+			if (file)
+				recording = true;
+		} else if (!want) {
+			attempted = false;
+			recording = false;
+		}
+
+		// read idle before full, so a page handed over just before the control
+		// task went idle is written before the file is closed
+		bool done = !recording && idle.load(std::memory_order_acquire);
+		int page = full.load(std::memory_order_acquire);
+		if (page != -1) {
+			if (file)
+				fwrite(&pages[page], sizeof(Page), 1, file);
+			full.store(-1, std::memory_order_release);
+		}
+
+		if (file && done) {
+			fclose(file);
+			file = nullptr;
+		}
+
+		pros::delay(write_period);
+	}
+}
+
+void init(bool autonomous) {
+	recorder::autonomous = autonomous;
+	if (started)
+		return;
+	started = true;
+
+	pros::Task writer_task(writerTask, TASK_PRIORITY_MIN + 1,
+	                       TASK_STACK_DEPTH_DEFAULT, "ARMS Recorder");
+}
+
+} // namespace arms::recorder
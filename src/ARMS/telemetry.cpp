@@ -0,0 +1,89 @@
+#include "ARMS/lib.h"
+#include "ARMS/ring.h"
+#include "api.h"
+#include "pros/apix.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace arms::telemetry {
+
+// records written by the control task and sent by the telemetry task
+Ring<Record, 64> queue;
+std::atomic<std::uint32_t> droppedCount{0};
+bool started = false;
+
+// time between sends, the queue holds 640 ms of records at a 10 ms loop
+const int send_period = 20;
+
+void push(const Record& record) {
+	if (!queue.push(record))
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool enabled() {
+	return started;
+}
+
+std::uint32_t dropped() {
+	return droppedCount.load(std::memory_order_relaxed);
+}
+
+// Consistent overhead byte stuffing: replace every zero byte so the only zero
+// in a frame is the delimiter at its end. Returns the encoded length
+// including the delimiter, at most n + 2 bytes.
+std::size_t cobs(const std::uint8_t* in, std::size_t n, std::uint8_t* out) {
+	std::size_t code_at = 0;
+	std::size_t o = 1;
+	std::uint8_t code = 1;
+	for (std::size_t i = 0; i < n; i++) {
+		if (in[i] == 0) {
+			out[code_at] = code;
+			code_at = o++;
+			code = 1;
+		} else {
+			out[o++] = in[i];
+			code++;
+		}
+	}
+	out[code_at] = code;
+	out[o++] = 0;
+	return o;
+}
+
+int telemetryTask() {
+	// version, record and checksum
+	std::uint8_t frame[sizeof(Record) + 2];
+	std::uint8_t encoded[sizeof(frame) + 2];
+
+	std::uint32_t now = pros::millis();
+	while (true) {
+		Record record;
+		while (queue.pop(record)) {
+			frame[0] = VERSION;
+			std::memcpy(frame + 1, &record, sizeof(Record));
+			std::uint8_t sum = 0;
+			for (std::size_t i = 0; i < sizeof(frame) - 1; i++)
+				sum += frame[i];
+			frame[sizeof(frame) - 1] = sum;
+
+			std::size_t n = cobs(frame, sizeof(frame), encoded);
+			fwrite(encoded, 1, n, stdout);
+		}
+		fflush(stdout);
+
+		pros::Task::delay_until(&now, send_period);
+	}
+}
+
+void init() {
+	if (started)
+		return;
+	started = true;
+
+	pros::c::serctl(SERCTL_DISABLE_COBS, NULL);
+	pros::Task telemetry_task(telemetryTask, TASK_PRIORITY_MIN + 1,
+	                          TASK_STACK_DEPTH_DEFAULT, "ARMS Telemetry");
+}
+
+} // namespace arms::telemetry
@@ -0,0 +1,138 @@
+#include "ARMS/trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace arms {
+
+Path spline(const std::vector<std::vector<double>>& waypoints,
+            Spline_e_t type) {
+	if (type == SPLINE_HERMITE)
+		return HermitePath(waypoints);
+
+	std::vector<Point> points;
+	for (const std::vector<double>& w : waypoints)
+		points.push_back({w.at(0), w.at(1)});
+	return CatmullRomPath(points);
+}
+
+Trajectory::Trajectory(std::vector<std::vector<double>> waypoints,
+                       TrajectoryConstraints constraints, Spline_e_t type,
+                       bool reversed)
+    : Trajectory(spline(waypoints, type), constraints, reversed) {
+}
+
+Trajectory::Trajectory(const Path& path, TrajectoryConstraints constraints,
+                       bool reversed)
+    : constraints(constraints) {
+	const std::vector<PathPoint>& points = path.getPoints();
+	if (points.size() < 2)
+		return;
+
+	states.reserve(points.size());
+	for (const PathPoint& p : points) {
+		TrajectoryState state = {};
+		state.distance = p.distance;
+		state.position = p.position;
+		state.heading = p.heading;
+		state.curvature = p.curvature;
+		states.push_back(state);
+	}
+
+	// the outer wheel of a turn moves at v * (1 + |curvature| * width / 2)
+	for (TrajectoryState& s : states)
+		s.velocity = constraints.velocity /
+		             (1 + fabs(s.curvature) * constraints.trackWidth / 2);
+	states.front().velocity = 0;
+	states.back().velocity = 0;
+
+	// limit the acceleration forwards, then the deceleration backwards
+	double a2 = 2 * constraints.acceleration;
+	for (std::size_t i = 1; i < states.size(); i++) {
+		double ds = states[i].distance - states[i - 1].distance;
+		states[i].velocity = std::min(
+		    states[i].velocity, std::sqrt(states[i - 1].velocity *
+		                                      states[i - 1].velocity + a2 * ds));
+	}
+	for (std::size_t i = states.size() - 1; i-- > 0;) {
+		double ds = states[i + 1].distance - states[i].distance;
+		states[i].velocity = std::min(
+		    states[i].velocity, std::sqrt(states[i + 1].velocity *
+		                                      states[i + 1].velocity + a2 * ds));
+	}
+
+	// time each step by its average velocity
+	for (std::size_t i = 1; i < states.size(); i++) {
+		TrajectoryState& prev = states[i - 1];
+		TrajectoryState& s = states[i];
+		double ds = s.distance - prev.distance;
+		double v = prev.velocity + s.velocity;
+		double dt = v > 0 ? 2 * ds / v : 0;
+		s.time = prev.time + dt;
+		prev.acceleration = dt > 0 ? (s.velocity - prev.velocity) / dt : 0;
+	}
+
+	// driving backwards the robot faces away from the direction of travel
+	if (reversed) {
+		for (TrajectoryState& s : states) {
+			s.heading = remainder(s.heading + M_PI, 2 * M_PI);
+			s.velocity = -s.velocity;
+			s.acceleration = -s.acceleration;
+			s.curvature = -s.curvature;
+		}
+	}
+}
+
+TrajectoryState TrajectoryView::sample(double t) const {
+	if (count == 0)
+		return {};
+	if (t <= 0)
+		return states[0];
+	if (t >= states[count - 1].time)
+		return states[count - 1];
+
+	// first state after t
+	const TrajectoryState* it = std::upper_bound(
+	    states, states + count, t,
+	    [](double t, const TrajectoryState& s) { return t < s.time; });
+	const TrajectoryState& b = *it;
+	const TrajectoryState& a = *(it - 1);
+	double f = (t - a.time) / (b.time - a.time);
+
+	TrajectoryState s = a;
+	s.time = t;
+	s.distance = a.distance + (b.distance - a.distance) * f;
+	Point pa = a.position;
+	Point pb = b.position;
+	s.position = pa + (pb - pa) * f;
+	s.heading = a.heading + remainder(b.heading - a.heading, 2 * M_PI) * f;
+	s.velocity = a.velocity + (b.velocity - a.velocity) * f;
+	s.curvature = a.curvature + (b.curvature - a.curvature) * f;
+	return s;
+}
+
+double TrajectoryView::duration() const {
+	return count ? states[count - 1].time : 0;
+}
+
+TrajectoryState Trajectory::sample(double t) const {
+	return view().sample(t);
+}
+
+double Trajectory::duration() const {
+	return view().duration();
+}
+
+const std::vector<TrajectoryState>& Trajectory::getStates() const {
+	return states;
+}
+
+TrajectoryConstraints Trajectory::getConstraints() const {
+	return constraints;
+}
+
+TrajectoryView Trajectory::view() const {
+	return {states.data(), states.size(), constraints};
+}
+
+} // namespace arms
@@ -0,0 +1,163 @@
+/*
+ * Bake ARMS trajectories into a header so they are stored in flash instead of
+ * being generated on the brain at the start of a match.
+ *
+ * Build on the host with the library's own generator and run it on a path
+ * file:
+ *
+ *     make tools
+ *     bin/host/bake_paths paths.txt > include/paths.h
+ *
+ * A path file lists any number of paths. Each starts with a header line, is
+ * followed by one waypoint per line, as {x, y} or {x, y, heading} in inches
+ * and degrees, and ends with "end". Lines starting with # are ignored.
+ *
+ *     # name velocity acceleration track_width spline [reversed]
+ *     path toGoal 60 80 12 hermite
+ *     0 0 0
+ *     24 24 90
+ *     end
+ *
+ * The spline is hermite, catmull_rom or bezier. Each path becomes a
+ * constexpr arms::TrajectoryView of the same name that can be passed straight
+ * to arms::chassis::follow(). Values are printed with enough digits to read
+ * back as the same doubles, and everything is inline so the header can be
+ * included from several files with one copy of each path in flash.
+ */
+
+#include "ARMS/trajectory.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace arms;
+
+namespace {
+
+struct Spec {
+	std::string name;
+	TrajectoryConstraints constraints;
+	std::string spline;
+	bool reversed;
+	std::vector<std::vector<double>> waypoints;
+};
+
+[[noreturn]] void fail(int line, const std::string& message) {
+	std::cerr << "line " << line << ": " << message << std::endl;
+	std::exit(1);
+}
+
+Trajectory generate(const Spec& spec) {
+	if (spec.spline == "hermite")
+		return Trajectory(spec.waypoints, spec.constraints, SPLINE_HERMITE,
+		                  spec.reversed);
+	if (spec.spline == "catmull_rom")
+		return Trajectory(spec.waypoints, spec.constraints, SPLINE_CATMULL_ROM,
+		                  spec.reversed);
+
+	std::vector<Point> points;
+	for (const std::vector<double>& w : spec.waypoints)
+		points.push_back({w[0], w[1]});
+	return Trajectory(BezierPath(points), spec.constraints, spec.reversed);
+}
+
+void emit(const Spec& spec, const Trajectory& trajectory) {
+	const std::vector<TrajectoryState>& states = trajectory.getStates();
+	TrajectoryConstraints c = spec.constraints;
+
+	std::printf("inline constexpr arms::TrajectoryState %s_states[] = {\n",
+	            spec.name.c_str());
+	for (const TrajectoryState& s : states)
+		std::printf("    {%.17g, %.17g, {{%.17g, %.17g}}, %.17g, %.17g, %.17g, "
+		            "%.17g},\n",
+		            s.time, s.distance, s.position.x, s.position.y, s.heading,
+		            s.velocity, s.acceleration, s.curvature);
+	std::printf("};\n");
+	std::printf("inline constexpr arms::TrajectoryView %s = {\n",
+	            spec.name.c_str());
+	std::printf("    %s_states, %zu, {%.17g, %.17g, %.17g}};\n\n",
+	            spec.name.c_str(), states.size(), c.velocity, c.acceleration,
+	            c.trackWidth);
+
+	std::cerr << spec.name << ": " << states.size() << " states, "
+	          << trajectory.duration() << " s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc != 2) {
+		std::cerr << "usage: " << argv[0] << " paths.txt" << std::endl;
+		return 1;
+	}
+
+	std::ifstream file(argv[1]);
+	if (!file) {
+		std::cerr << "cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::printf("// Generated by tools/bake_paths.cpp from %s, do not edit\n",
+	            argv[1]);
+	std::printf("#pragma once\n\n#include \"ARMS/trajectory.h\"\n\n");
+	std::printf("namespace paths {\n\n");
+
+	Spec spec;
+	bool open = false;
+	std::string text;
+	for (int line = 1; std::getline(file, text); line++) {
+		std::istringstream in(text);
+		std::string word;
+		if (!(in >> word) || word[0] == '#')
+			continue;
+
+		if (word == "path") {
+			if (open)
+				fail(line, "path " + spec.name + " has no end");
+			spec = {};
+			std::string reversed;
+			if (!(in >> spec.name >> spec.constraints.velocity >>
+			      spec.constraints.acceleration >> spec.constraints.trackWidth >>
+			      spec.spline))
+				fail(line, "expected: path name velocity acceleration "
+				           "track_width spline [reversed]");
+			if (spec.spline != "hermite" && spec.spline != "catmull_rom" &&
+			    spec.spline != "bezier")
+				fail(line, "unknown spline " + spec.spline);
+			spec.reversed = (in >> reversed) && reversed == "reversed";
+			open = true;
+		} else if (word == "end") {
+			if (!open)
+				fail(line, "end without path");
+			if (spec.waypoints.size() < 2)
+				fail(line, "path " + spec.name + " needs two waypoints");
+			if (spec.spline == "bezier" && spec.waypoints.size() % 3 != 1)
+				fail(line, "a bezier path needs 3n + 1 control points");
+			Trajectory trajectory = generate(spec);
+			if (trajectory.getStates().empty())
+				fail(line, "path " + spec.name + " is empty");
+			emit(spec, trajectory);
+			open = false;
+		} else {
+			if (!open)
+				fail(line, "waypoint outside a path");
+			std::istringstream values(text);
+			std::vector<double> waypoint;
+			double v;
+			while (values >> v)
+				waypoint.push_back(v);
+			if (waypoint.size() < 2 || waypoint.size() > 3)
+				fail(line, "expected x y [heading]");
+			spec.waypoints.push_back(waypoint);
+		}
+	}
+	if (open)
+		std::cerr << "path " << spec.name << " has no end" << std::endl;
+
+	std::printf("} // namespace paths\n");
+	return open;
+}
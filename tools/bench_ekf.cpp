@@ -0,0 +1,230 @@
+/*
+ * Check the ARMS extended Kalman filter on the host, with synthetic wheel,
+ * imu and gps streams from a robot driving random spirals.
+ *
+ *     g++ -std=c++17 -O2 -Iinclude tools/bench_ekf.cpp src/ARMS/ekf.cpp \
+ *         -o bench_ekf
+ *     ./bench_ekf [runs]
+ *
+ * The wheels read a few percent long and the track width is a little off,
+ * as on a real drive, so dead reckoning alone drifts. The imu heading and
+ * the gps position are noisy but unbiased, and the gps reports at its own
+ * slower rate. Each run is fed to the filter the same way odom::update()
+ * does, and the position and heading errors are reported over the whole run
+ * and at its end, next to dead reckoning on the same wheels. The filter time
+ * is reported in nanoseconds per tick, to compare against the loop period.
+ */
+
+#include "ARMS/ekf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace arms;
+using namespace arms::odom;
+
+namespace {
+
+const double PERIOD = 0.010;       // seconds per tick
+const double DURATION = 60;        // seconds per run
+const double SPEED = 60;           // largest speed, inches per second
+const double CURVATURE = 1.0 / 12; // largest curvature, per inch
+const double SEGMENT = 0.75;       // seconds per spiral
+const int SUBSTEPS = 20;           // truth steps per tick
+
+const double WHEEL_SCALE = 1.03; // wheels read 3% long
+const double TURN_SCALE = 0.97;  // track width 3% too wide
+const double WHEEL_NOISE = 0.01; // inches per inch travelled
+
+const double IMU_SIGMA = 0.01; // radians
+const double GPS_SIGMA = 1.0;  // inches
+const int GPS_TICKS = 5;       // ticks between gps readings
+
+// the variances odom.cpp gives the filter
+const double IMU_VARIANCE = 1e-4;
+const double GPS_MIN_VARIANCE = 1.0;
+
+// what the filter sees on one tick
+struct Tick {
+	double forward, strafe, delta_angle; // wheels, in the robot frame
+	double heading;                      // imu
+	bool gps;                            // a new gps reading this tick
+	Point position;                      // gps
+	Point true_position;
+	double true_heading;
+};
+
+double wrap(double angle) {
+	return std::remainder(angle, 2 * M_PI);
+}
+
+// one random drive, sampled once per tick
+std::vector<Tick> drive(unsigned seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> curvatures(-CURVATURE, CURVATURE);
+	std::uniform_real_distribution<double> speeds(SPEED / 4, SPEED);
+	std::normal_distribution<double> normal(0, 1);
+
+	double x = 0, y = 0, heading = 0;
+	double k0 = curvatures(random), k1 = curvatures(random);
+	double v0 = speeds(random), v1 = speeds(random);
+	double segment_start = 0;
+
+	std::vector<Tick> ticks;
+	int count = DURATION / PERIOD;
+	for (int i = 0; i < count; i++) {
+		double forward = 0, strafe = 0, delta_angle = 0;
+		double start_heading = heading;
+		for (int j = 0; j < SUBSTEPS; j++) {
+			double t = (i * SUBSTEPS + j) * PERIOD / SUBSTEPS;
+			if (t >= segment_start + SEGMENT) {
+				k0 = k1;
+				k1 = curvatures(random);
+				v0 = v1;
+				v1 = speeds(random);
+				segment_start += SEGMENT;
+			}
+			double f = (t - segment_start) / SEGMENT;
+			double ds = (v0 + (v1 - v0) * f) * PERIOD / SUBSTEPS;
+			double dh = ds * (k0 + (k1 - k0) * f);
+			double dx = ds * cos(heading + dh / 2);
+			double dy = ds * sin(heading + dh / 2);
+			x += dx;
+			y += dy;
+			heading += dh;
+
+			// the same step in the robot frame at the start of the tick
+			double c = cos(start_heading), s = sin(start_heading);
+			forward += c * dx + s * dy;
+			strafe += -s * dx + c * dy;
+			delta_angle += dh;
+		}
+
+		// the filter predicts along the midpoint heading, so hand it the
+		// displacement in that frame, as the arc integrator would see it
+		double h = delta_angle / 2;
+		Tick tick;
+		tick.forward = (cos(h) * forward + sin(h) * strafe) *
+		               (WHEEL_SCALE + WHEEL_NOISE * normal(random));
+		tick.strafe = (-sin(h) * forward + cos(h) * strafe) * WHEEL_SCALE;
+		tick.delta_angle = delta_angle * TURN_SCALE;
+		tick.heading = heading + IMU_SIGMA * normal(random);
+		tick.gps = i % GPS_TICKS == 0;
+		tick.position = {x + GPS_SIGMA * normal(random),
+		                 y + GPS_SIGMA * normal(random)};
+		tick.true_position = {x, y};
+		tick.true_heading = heading;
+		ticks.push_back(tick);
+	}
+	return ticks;
+}
+
+struct Errors {
+	double rms_position = 0; // inches
+	double final_position = 0;
+	double rms_heading = 0; // degrees
+	double final_heading = 0;
+
+	void add(const Tick& tick, Point position, double heading, bool last) {
+		double dp = hypot(position.x - tick.true_position.x,
+		                  position.y - tick.true_position.y);
+		double dh = wrap(heading - tick.true_heading) * 180 / M_PI;
+		rms_position += dp * dp;
+		rms_heading += dh * dh;
+		if (last) {
+			final_position = dp;
+			final_heading = fabs(dh);
+		}
+	}
+
+	void finish(std::size_t count, Errors& total) {
+		total.rms_position += sqrt(rms_position / count);
+		total.rms_heading += sqrt(rms_heading / count);
+		total.final_position += final_position;
+		total.final_heading += final_heading;
+	}
+};
+
+// the filter and dead reckoning over one drive, adding their errors and the
+// filter time in nanoseconds
+void run(const std::vector<Tick>& ticks, Errors& ekf_total,
+         Errors& odom_total, double& nanoseconds) {
+	std::vector<Point> positions(ticks.size());
+	std::vector<double> headings(ticks.size());
+
+	static EKF ekf;
+	ekf.reset({0, 0}, 0);
+	std::chrono::steady_clock::time_point start =
+	    std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < ticks.size(); i++) {
+		const Tick& tick = ticks[i];
+		ekf.predict(tick.forward, tick.strafe, tick.delta_angle);
+		ekf.updateHeading(tick.heading, IMU_VARIANCE);
+		if (tick.gps)
+			ekf.updatePosition(tick.position,
+			                   std::max(GPS_SIGMA * GPS_SIGMA, GPS_MIN_VARIANCE));
+		positions[i] = ekf.getPosition();
+		headings[i] = ekf.getHeading();
+	}
+	nanoseconds += std::chrono::duration<double, std::nano>(
+	                   std::chrono::steady_clock::now() - start)
+	                   .count();
+
+	Errors ekf_run, odom_run;
+	double x = 0, y = 0, heading = 0;
+	for (std::size_t i = 0; i < ticks.size(); i++) {
+		const Tick& tick = ticks[i];
+		double p = heading + tick.delta_angle / 2;
+		x += cos(p) * tick.forward - sin(p) * tick.strafe;
+		y += sin(p) * tick.forward + cos(p) * tick.strafe;
+		heading += tick.delta_angle;
+
+		bool last = i + 1 == ticks.size();
+		ekf_run.add(tick, positions[i], headings[i], last);
+		odom_run.add(tick, {x, y}, heading, last);
+	}
+	ekf_run.finish(ticks.size(), ekf_total);
+	odom_run.finish(ticks.size(), odom_total);
+}
+
+void report(const char* name, const Errors& errors, int runs) {
+	std::printf("%-16s%10.2f%10.2f%10.2f%10.2f\n", name,
+	            errors.rms_position / runs, errors.final_position / runs,
+	            errors.rms_heading / runs, errors.final_heading / runs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int runs = argc > 1 ? std::atoi(argv[1]) : 10;
+	if (runs <= 0) {
+		std::fprintf(stderr, "usage: %s [runs]\n", argv[0]);
+		return 1;
+	}
+
+	Errors ekf, odom;
+	double nanoseconds = 0;
+	std::size_t ticks = 0;
+	for (int seed = 1; seed <= runs; seed++) {
+		std::vector<Tick> stream = drive(seed);
+		run(stream, ekf, odom, nanoseconds);
+		ticks += stream.size();
+	}
+
+	std::printf("mean of %d runs of %.0f s at up to %.0f in/s, gps every "
+	            "%d ticks\n\n",
+	            runs, DURATION, SPEED, GPS_TICKS);
+	std::printf("%-16s%10s%10s%10s%10s\n", "", "rms in", "final in",
+	            "rms deg", "final deg");
+	report("ekf", ekf, runs);
+	report("dead reckoning", odom, runs);
+	std::printf("\nekf %.0f ns per tick, %.4f%% of a %.0f ms loop\n",
+	            nanoseconds / ticks, nanoseconds / ticks / (PERIOD * 1e7),
+	            PERIOD * 1000);
+	return 0;
+}
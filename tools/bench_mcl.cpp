@@ -0,0 +1,114 @@
+/*
+ * Time the ARMS particle filter on the host, with synthetic odometry and
+ * distance sensor readings from a robot driving circles on the field.
+ *
+ *     g++ -std=c++17 -Os -Iinclude tools/bench_mcl.cpp src/ARMS/particle.cpp \
+ *         -o bench_mcl
+ *     ./bench_mcl [updates]
+ *
+ * Build with the same flags as the robot to compare them; add
+ * -fopt-info-vec to see which loops the compiler vectorized. Each step is
+ * reported in particles per millisecond, along with the final error of the
+ * estimate so a faster build can be checked for still localizing.
+ */
+
+#include "ARMS/mcl.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace arms;
+using namespace arms::mcl;
+
+namespace {
+
+const double FIELD_SIZE = 140.4;
+
+// the sensors of the default config.h example
+const Reading SENSORS[] = {{6, 0, 0, 0},
+                           {0, 7, (float)M_PI_2, 0},
+                           {0, -7, (float)-M_PI_2, 0},
+                           {-6, 0, (float)M_PI, 0}};
+
+// exact range to the field wall from a sensor on a robot at a pose
+float range(const Reading& sensor, double x, double y, double heading) {
+	double c = cos(heading), s = sin(heading);
+	double sx = x + c * sensor.x - s * sensor.y;
+	double sy = y + s * sensor.x + c * sensor.y;
+	double dx = cos(heading + sensor.angle), dy = sin(heading + sensor.angle);
+	double half = FIELD_SIZE / 2;
+	double tx = (copysign(half, dx) - sx) / dx;
+	double ty = (copysign(half, dy) - sy) / dy;
+	return fmin(tx, ty);
+}
+
+using Clock = std::chrono::steady_clock;
+
+double since(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start)
+	    .count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int updates = argc > 1 ? std::atoi(argv[1]) : 2000;
+	const std::size_t sensors = sizeof(SENSORS) / sizeof(SENSORS[0]);
+
+	// static, like the filter on the robot
+	static ParticleFilter filter;
+	double x = 24, y = -12, heading = 0.3;
+	filter.init({x, y}, heading, 2, 2 * M_PI / 180, FIELD_SIZE);
+
+	double predict_ms = 0, weigh_ms = 0, resample_ms = 0;
+	unsigned seed = 1;
+	for (int i = 0; i < updates; i++) {
+		// drive 1 inch per update around a 30 inch circle, with the odometry
+		// reporting a little less than the robot really moved
+		double forward = 1, turn = 1.0 / 30;
+		x += forward * cos(heading + turn / 2);
+		y += forward * sin(heading + turn / 2);
+		heading += turn;
+
+		Reading readings[sensors];
+		for (std::size_t r = 0; r < sensors; r++) {
+			seed = seed * 1103515245 + 12345;
+			float noise = ((seed >> 16) % 1000 / 1000.0f - 0.5f) * 0.5f;
+			readings[r] = SENSORS[r];
+			readings[r].range = range(SENSORS[r], x, y, heading) + noise;
+		}
+
+		Clock::time_point start = Clock::now();
+		filter.predict(forward * 0.98, 0, turn);
+		predict_ms += since(start);
+
+		start = Clock::now();
+		filter.weigh(readings, sensors);
+		weigh_ms += since(start);
+
+		start = Clock::now();
+		filter.resample();
+		resample_ms += since(start);
+	}
+
+	Point position;
+	double estimate, spread;
+	filter.estimate(position, estimate, spread);
+
+	double particles = (double)ParticleFilter::PARTICLES * updates;
+	std::printf("%zu particles, %d updates, %zu sensors\n",
+	            ParticleFilter::PARTICLES, updates, sensors);
+	std::printf("predict   %10.0f particles/ms\n", particles / predict_ms);
+	std::printf("weigh     %10.0f particles/ms\n", particles / weigh_ms);
+	std::printf("resample  %10.0f particles/ms\n", particles / resample_ms);
+	std::printf("total     %10.0f particles/ms, %.1f us per update\n",
+	            particles / (predict_ms + weigh_ms + resample_ms),
+	            (predict_ms + weigh_ms + resample_ms) * 1000 / updates);
+	std::printf("error %.2f in, %.2f deg, spread %.2f in\n",
+	            std::hypot(position.x - x, position.y - y),
+	            std::remainder(estimate - heading, 2 * M_PI) * 180 / M_PI,
+	            spread);
+	return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Compare the ARMS odometry integrators on synthetic encoder streams.
+ *
+ *     g++ -std=c++17 -O2 -Iinclude tools/bench_odom.cpp src/ARMS/integrate.cpp \
+ *         -o bench_odom
+ *     ./bench_odom [runs]
+ *
+ * A robot with a right tracking wheel, a middle wheel and an imu drives a
+ * chain of random spirals, its curvature and speed blending from one random
+ * value to the next, since on a constant arc every integrator is exact. The
+ * true pose is integrated finely, while the odometry samples the encoders at
+ * a jittered loop period and turns them into forward and sideways travel the
+ * same way odom::update() does. Each integrator is run on the same streams
+ * and its final position error is reported as drift in inches per metre
+ * driven, so the integrator can be chosen on data.
+ *
+ * The tick scenarios round the encoders to whole ticks, as on the robot, and
+ * the ideal ones do not, which separates the integration error from the
+ * quantization error that every integrator shares.
+ */
+
+#include "ARMS/integrate.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace arms;
+using namespace arms::odom;
+
+namespace {
+
+// tracking wheels, like the defaults in docs/api.md
+const double TPI = 41.4;                  // ticks per inch
+const double LEFT_RIGHT_DISTANCE = 6.375; // inches to each side wheel
+const double MIDDLE_DISTANCE = 5.75;      // inches behind the turning center
+
+const double DURATION = 60;     // seconds per run
+const double SPEED = 60;        // largest speed, inches per second
+const double SEGMENT = 0.75;    // seconds per spiral
+const double TRUTH_STEP = 1e-4; // seconds
+
+const double INCHES_PER_METRE = 39.3701;
+
+struct Scenario {
+	const char* name;
+	double curvature; // largest curvature, per inch
+	double period;    // odometry period in seconds
+	double jitter;    // largest period error in seconds
+	bool ticks;       // round the encoders to whole ticks
+};
+
+const Scenario SCENARIOS[] = {
+    {"gentle, 10 ms, ticks", 1.0 / 48, 0.010, 0.002, true},
+    {"tight, 10 ms, ticks", 1.0 / 8, 0.010, 0.002, true},
+    {"tight, 50 ms, ticks", 1.0 / 8, 0.050, 0.010, true},
+    {"gentle, 10 ms, ideal", 1.0 / 48, 0.010, 0.002, false},
+    {"tight, 10 ms, ideal", 1.0 / 8, 0.010, 0.002, false},
+    {"tight, 50 ms, ideal", 1.0 / 8, 0.050, 0.010, false},
+};
+
+typedef Point (*Integrator)(double, double, double, double);
+
+const struct {
+	const char* name;
+	Integrator integrate;
+} INTEGRATORS[] = {{"arc", integrateArc},
+                   {"exp", integrateExp},
+                   {"substep", integrateSubstep}};
+const int COUNT = sizeof(INTEGRATORS) / sizeof(INTEGRATORS[0]);
+
+// run each integrator over one random drive, adding the drift of each
+void run(const Scenario& scenario, unsigned seed, double drift[COUNT]) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> curvatures(-scenario.curvature,
+	                                                  scenario.curvature);
+	std::uniform_real_distribution<double> jitters(-scenario.jitter,
+	                                               scenario.jitter);
+
+	// truth, as arcs over each short step
+	double x = 0, y = 0, heading = 0, travelled = 0;
+	double right = 0, middle = 0; // wheel travel in inches
+
+	// odometry state of each integrator
+	Point position[COUNT] = {};
+	double prev_right = 0, prev_middle = 0, prev_heading = 0;
+	Point sampled = {0, 0}; // truth at the last sample
+	double sampled_travel = 0;
+
+	std::uniform_real_distribution<double> speeds(SPEED / 4, SPEED);
+	double k0 = curvatures(random), k1 = curvatures(random);
+	double v0 = speeds(random), v1 = speeds(random);
+	double segment_start = 0;
+	double next_sample = scenario.period + jitters(random);
+	for (double t = 0; t < DURATION; t += TRUTH_STEP) {
+		if (t >= segment_start + SEGMENT) {
+			k0 = k1;
+			k1 = curvatures(random);
+			v0 = v1;
+			v1 = speeds(random);
+			segment_start += SEGMENT;
+		}
+		double f = (t - segment_start) / SEGMENT;
+		double curvature = k0 + (k1 - k0) * f;
+
+		double ds = (v0 + (v1 - v0) * f) * TRUTH_STEP;
+		double dh = ds * curvature;
+		double chord = fabs(dh) > 1e-12 ? 2 * sin(dh / 2) / curvature : ds;
+		x += chord * cos(heading + dh / 2);
+		y += chord * sin(heading + dh / 2);
+		heading += dh;
+		travelled += ds;
+		right += ds + LEFT_RIGHT_DISTANCE * dh;
+		middle -= MIDDLE_DISTANCE * dh;
+
+		if (t < next_sample)
+			continue;
+		next_sample += scenario.period + jitters(random);
+
+		double r = scenario.ticks ? floor(right * TPI) : right * TPI;
+		double m = scenario.ticks ? floor(middle * TPI) : middle * TPI;
+		double delta_right = (r - prev_right) / TPI;
+		double delta_middle = (m - prev_middle) / TPI;
+		double delta_angle = heading - prev_heading;
+		prev_right = r;
+		prev_middle = m;
+		prev_heading = heading;
+		sampled = {x, y};
+		sampled_travel = travelled;
+
+		double forward = delta_right - LEFT_RIGHT_DISTANCE * delta_angle;
+		double strafe = delta_middle + MIDDLE_DISTANCE * delta_angle;
+		for (int i = 0; i < COUNT; i++) {
+			Point d =
+			    INTEGRATORS[i].integrate(forward, strafe, delta_angle, heading);
+			position[i].x += d.x;
+			position[i].y += d.y;
+		}
+	}
+
+	for (int i = 0; i < COUNT; i++)
+		drift[i] += hypot(position[i].x - sampled.x, position[i].y - sampled.y) /
+		            (sampled_travel / INCHES_PER_METRE);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int runs = argc > 1 ? std::atoi(argv[1]) : 10;
+	if (runs <= 0) {
+		std::fprintf(stderr, "usage: %s [runs]\n", argv[0]);
+		return 1;
+	}
+
+	std::printf("drift in inches per metre, mean of %d runs of %.0f s at "
+	            "up to %.0f in/s\n\n",
+	            runs, DURATION, SPEED);
+	std::printf("%-22s", "");
+	for (int i = 0; i < COUNT; i++)
+		std::printf("%10s", INTEGRATORS[i].name);
+	std::printf("\n");
+
+	for (const Scenario& scenario : SCENARIOS) {
+		double drift[COUNT] = {};
+		for (int seed = 1; seed <= runs; seed++)
+			run(scenario, seed, drift);
+		std::printf("%-22s", scenario.name);
+		for (int i = 0; i < COUNT; i++)
+			std::printf("%10.2e", drift[i] / runs);
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Fit the drive feedforward and effective track width from the tests run by
+ * arms::chassis::characterize().
+ *
+ * Copy /usd/arms_drive.bin off the sd card, then build and run on the host:
+ *
+ *     make tools
+ *     bin/host/fit_drive arms_drive.bin [inches_per_revolution]
+ *
+ * The motor velocities are recorded in rpm. Without inches_per_revolution,
+ * the distance the wheels cover per motor revolution is measured from the
+ * odometry over the straight tests.
+ *
+ * Each side is fit to V = kS sgn(v) + kV v + kA a by least squares over the
+ * straight tests, and the track width to (vr - vl) = w omega over the spins.
+ * Because the wheels scrub while turning, the fitted width is usually larger
+ * than the measured one, and it is the one to give trajectories. The output
+ * is the config.h lines to paste in.
+ */
+
+#include "ARMS/characterize.h"
+#include "ARMS/matrix.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace arms;
+using namespace arms::chassis;
+
+namespace {
+
+// wheel velocities below this are not moving, inches per second
+const double MIN_VELOCITY = 0.5;
+
+bool straight(const CharacterizeSample& s) {
+	return s.test >= TEST_QUASISTATIC_FORWARD && s.test <= TEST_DYNAMIC_BACKWARD;
+}
+
+bool spinning(const CharacterizeSample& s) {
+	return s.test == TEST_SPIN_LEFT || s.test == TEST_SPIN_RIGHT;
+}
+
+double seconds(const CharacterizeSample& a, const CharacterizeSample& b) {
+	return (double)(b.time - a.time) / 1e6;
+}
+
+// least squares fit of V = kS sgn(v) + kV v + kA a for one side
+struct SideFit {
+	Matrix<3, 3> xtx = Matrix<3, 3>::zero();
+	Matrix<3, 1> xty = Matrix<3, 1>::zero();
+	double sum_y = 0;
+	double sum_y2 = 0;
+	int n = 0;
+
+	void add(double voltage, double velocity, double acceleration) {
+		if (fabs(velocity) < MIN_VELOCITY)
+			return;
+		double x[3] = {velocity > 0 ? 1.0 : -1.0, velocity, acceleration};
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 3; j++)
+				xtx(i, j) += x[i] * x[j];
+			xty(i, 0) += x[i] * voltage;
+		}
+		sum_y += voltage;
+		sum_y2 += voltage * voltage;
+		n++;
+	}
+
+	// returns kS, kV, kA and the coefficient of determination
+	bool solve(double k[3], double& r2) const {
+		Matrix<3, 3> inv;
+		if (n < 3 || !invert(xtx, inv))
+			return false;
+		Matrix<3, 1> b = inv * xty;
+		for (int i = 0; i < 3; i++)
+			k[i] = b(i, 0);
+
+		// residual sum of squares from the normal equations
+		double explained = 0;
+		for (int i = 0; i < 3; i++)
+			explained += k[i] * xty(i, 0);
+		double total = sum_y2 - sum_y * sum_y / n;
+		r2 = total > 0 ? 1 - (sum_y2 - explained) / total : 0;
+		return true;
+	}
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+	if (argc < 2 || argc > 3) {
+		std::fprintf(stderr, "usage: %s arms_drive.bin [inches_per_revolution]\n",
+		             argv[0]);
+		return 1;
+	}
+
+	FILE* file = std::fopen(argv[1], "rb");
+	if (!file) {
+		std::fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+	CharacterizeHeader header;
+	if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+	    std::string(header.magic, 4) != "ARMS" ||
+	    header.version != CHARACTERIZE_VERSION ||
+	    header.sampleSize != sizeof(CharacterizeSample)) {
+		std::fprintf(stderr, "%s is not a version %d characterization\n",
+		             argv[1], CHARACTERIZE_VERSION);
+		return 1;
+	}
+	std::vector<CharacterizeSample> samples(header.count);
+	samples.resize(std::fread(samples.data(), sizeof(CharacterizeSample),
+	                          header.count, file));
+	std::fclose(file);
+	if (samples.size() != header.count)
+		std::fprintf(stderr, "warning: file truncated after %zu samples\n",
+		             samples.size());
+
+	// distance per motor revolution, from the distance the odometry saw
+	// against the revolutions the motors made
+	double ipr = argc == 3 ? std::atof(argv[2]) : 0;
+	if (ipr <= 0) {
+		double inches = 0, revolutions = 0;
+		for (std::size_t i = 1; i < samples.size(); i++) {
+			const CharacterizeSample& a = samples[i - 1];
+			const CharacterizeSample& b = samples[i];
+			if (a.test != b.test || !straight(b))
+				continue;
+			inches += std::hypot(b.x - a.x, b.y - a.y);
+			double rpm = (fabs(a.leftVelocity) + fabs(a.rightVelocity) +
+			              fabs(b.leftVelocity) + fabs(b.rightVelocity)) /
+			             4;
+			revolutions += rpm / 60 * seconds(a, b);
+		}
+		if (revolutions <= 0) {
+			std::fprintf(stderr, "the robot did not move\n");
+			return 1;
+		}
+		ipr = inches / revolutions;
+	}
+	double scale = ipr / 60; // rpm to inches per second
+
+	// accelerations by central differences within each test
+	SideFit left, right;
+	double sum_turn = 0, sum_omega2 = 0;
+	for (std::size_t i = 1; i + 1 < samples.size(); i++) {
+		const CharacterizeSample& a = samples[i - 1];
+		const CharacterizeSample& s = samples[i];
+		const CharacterizeSample& b = samples[i + 1];
+		if (a.test != s.test || b.test != s.test)
+			continue;
+		double dt = seconds(a, b);
+		if (dt <= 0)
+			continue;
+
+		if (straight(s)) {
+			left.add(s.leftVoltage / 1000.0, s.leftVelocity * scale,
+			         (b.leftVelocity - a.leftVelocity) * scale / dt);
+			right.add(s.rightVoltage / 1000.0, s.rightVelocity * scale,
+			          (b.rightVelocity - a.rightVelocity) * scale / dt);
+		} else if (spinning(s)) {
+			double omega = std::remainder(b.heading - a.heading, 2 * M_PI) / dt;
+			double difference = (s.rightVelocity - s.leftVelocity) * scale;
+			if (fabs(omega) < 0.1)
+				continue;
+			sum_turn += difference * omega;
+			sum_omega2 += omega * omega;
+		}
+	}
+
+	double kl[3], kr[3], r2l, r2r;
+	if (!left.solve(kl, r2l) || !right.solve(kr, r2r)) {
+		std::fprintf(stderr, "not enough moving samples to fit\n");
+		return 1;
+	}
+
+	std::printf("// %zu samples, %.4f inches per motor revolution\n",
+	            samples.size(), ipr);
+	std::printf("// left r^2 %.4f, right r^2 %.4f\n", r2l, r2r);
+	std::printf("#define LEFT_FEEDFORWARD %.4f, %.5f, %.5f\n", kl[0], kl[1],
+	            kl[2]);
+	std::printf("#define RIGHT_FEEDFORWARD %.4f, %.5f, %.5f\n", kr[0], kr[1],
+	            kr[2]);
+	if (sum_omega2 > 0)
+		std::printf("// effective track width %.3f inches, for trajectories\n",
+		            sum_turn / sum_omega2);
+	return 0;
+}
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Convert an ARMS sd card recording to CSV.
+
+Set RECORD_AUTONOMOUS in config.h, or call arms::recorder::start() and stop(),
+then copy /usd/arms_NNN.bin off the card and run:
+
+    python3 tools/recorder.py arms_000.bin > run.csv
+
+The file is a sequence of 4096 byte pages, each starting with a header that
+gives the format version and entry size. Lost or dropped entries are reported
+on stderr.
+"""
+
+import csv
+import struct
+import sys
+
+PAGE_SIZE = 4096
+HEADER = struct.Struct("<4sHHIHH")
+
+# entry layouts by format version, matching arms::recorder::Entry
+ENTRIES = {
+    1: (struct.Struct("<IfffffffhhBBH"),
+        ["time", "x", "y", "heading", "linear_error", "angular_error",
+         "linear_integral", "angular_integral", "left_voltage",
+         "right_voltage", "mode", "exit_reason", "command"]),
+}
+
+EXIT_REASONS = ["", "target", "settled", "replaced"]
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: recorder.py arms_NNN.bin")
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    writer = None
+    expected = 0
+    for offset in range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE):
+        magic, version, size, sequence, count, dropped = HEADER.unpack_from(
+            data, offset)
+        if magic != b"ARMS":
+            sys.exit("page %d is not an ARMS recording" % (offset // PAGE_SIZE))
+        if version not in ENTRIES:
+            sys.exit("unsupported recording version %d" % version)
+        entry, fields = ENTRIES[version]
+
+        if writer is None:
+            writer = csv.writer(sys.stdout)
+            writer.writerow(fields)
+        if sequence != expected:
+            print("pages %d to %d are missing" % (expected, sequence - 1),
+                  file=sys.stderr)
+        expected = sequence + 1
+
+        reason = fields.index("exit_reason")
+        for i in range(count):
+            row = list(entry.unpack_from(data, offset + HEADER.size + i * size))
+            if row[reason] < len(EXIT_REASONS):
+                row[reason] = EXIT_REASONS[row[reason]]
+            writer.writerow(row)
+
+    if expected and dropped:
+        print("%d entries were dropped" % dropped, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
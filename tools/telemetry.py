@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Convert the ARMS telemetry stream to CSV.
+
+Enable ODOM_DEBUG in config.h, then read the brain's serial port directly:
+
+    python3 tools/telemetry.py /dev/ttyACM1 > run.csv
+
+or save the raw stream first and convert it later:
+
+    cat /dev/ttyACM1 > run.bin
+    python3 tools/telemetry.py run.bin > run.csv
+
+Frames that fail the checksum, such as text printed by the program, are
+skipped and counted on stderr.
+"""
+
+import csv
+import struct
+import sys
+
+VERSION = 1
+
+# must match arms::telemetry::Record
+RECORD = struct.Struct("<IIffffffffHH")
+FIELDS = ["time", "loop_time", "x", "y", "heading", "target_x", "target_y",
+          "target_heading", "left", "right", "mode", "command"]
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(stream):
+    buffer = bytearray()
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            return
+        buffer += chunk
+        while True:
+            end = buffer.find(0)
+            if end < 0:
+                break
+            yield bytes(buffer[:end])
+            del buffer[:end + 1]
+
+
+def decode(frame):
+    data = cobs_decode(frame)
+    if data is None or len(data) != RECORD.size + 2:
+        return None
+    if data[0] != VERSION or sum(data[:-1]) & 0xFF != data[-1]:
+        return None
+    return RECORD.unpack(data[1:-1])
+
+
+def main():
+    if len(sys.argv) > 2:
+        sys.exit("usage: telemetry.py [port or file]")
+    stream = open(sys.argv[1], "rb") if len(sys.argv) == 2 else sys.stdin.buffer
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(FIELDS)
+    bad = 0
+    try:
+        for frame in frames(stream):
+            record = decode(frame)
+            if record is None:
+                bad += 1
+                continue
+            writer.writerow(record)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    if bad:
+        print("skipped %d bad frames" % bad, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()